@@ -0,0 +1,191 @@
+; Carry-chain loops over little-endian arrays of qwords, callable from C
+; with the System V AMD64 calling convention. These are add_long_long,
+; mul_long_short and div_long_short from add.asm, which keep their
+; register interface for the programs built from it, reworked to take
+; explicit lengths that may be zero and separate operands, and to return
+; the carry instead of leaving it in flags or memory; sub_n, addmul_1 and
+; submul_1 follow the same pattern. The result array may coincide with
+; the first operand.
+
+                section         .text
+
+                global          asm_add_n:function
+                global          asm_sub_n:function
+                global          asm_mul_1:function
+                global          asm_addmul_1:function
+                global          asm_submul_1:function
+                global          asm_divrem_1:function
+
+; adds two long numbers
+;    rdi -- address of the result
+;    rsi -- address of summand #1
+;    rdx -- address of summand #2
+;    rcx -- length of long numbers in qwords
+; result:
+;    rax -- carry out of the top qword
+asm_add_n:
+                xor             eax, eax
+                test            rcx, rcx
+                jz              .done
+
+                lea             rsi, [rsi + 8 * rcx]
+                lea             rdx, [rdx + 8 * rcx]
+                lea             rdi, [rdi + 8 * rcx]
+                neg             rcx
+                clc
+.loop:
+                mov             r8, [rsi + 8 * rcx]
+                adc             r8, [rdx + 8 * rcx]
+                mov             [rdi + 8 * rcx], r8
+                inc             rcx
+                jnz             .loop
+
+                setc            al
+.done:
+                ret
+
+; subtracts two long numbers
+;    rdi -- address of the result
+;    rsi -- address of the minuend
+;    rdx -- address of the subtrahend
+;    rcx -- length of long numbers in qwords
+; result:
+;    rax -- borrow out of the top qword
+asm_sub_n:
+                xor             eax, eax
+                test            rcx, rcx
+                jz              .done
+
+                lea             rsi, [rsi + 8 * rcx]
+                lea             rdx, [rdx + 8 * rcx]
+                lea             rdi, [rdi + 8 * rcx]
+                neg             rcx
+                clc
+.loop:
+                mov             r8, [rsi + 8 * rcx]
+                sbb             r8, [rdx + 8 * rcx]
+                mov             [rdi + 8 * rcx], r8
+                inc             rcx
+                jnz             .loop
+
+                setc            al
+.done:
+                ret
+
+; multiplies long number by a short
+;    rdi -- address of the result
+;    rsi -- address of multiplier #1 (long number)
+;    rdx -- length of long number in qwords
+;    rcx -- multiplier #2 (64-bit unsigned)
+; result:
+;    rax -- high qword of the product
+asm_mul_1:
+                mov             r8, rdx
+                xor             r9d, r9d
+                test            r8, r8
+                jz              .done
+
+                lea             rsi, [rsi + 8 * r8]
+                lea             rdi, [rdi + 8 * r8]
+                neg             r8
+.loop:
+                mov             rax, [rsi + 8 * r8]
+                mul             rcx
+                add             rax, r9
+                adc             rdx, 0
+                mov             [rdi + 8 * r8], rax
+                mov             r9, rdx
+                inc             r8
+                jnz             .loop
+
+.done:
+                mov             rax, r9
+                ret
+
+; adds the product of a long number and a short to the result
+;    rdi -- address of the result (long number)
+;    rsi -- address of multiplier #1 (long number)
+;    rdx -- length of long numbers in qwords
+;    rcx -- multiplier #2 (64-bit unsigned)
+; result:
+;    rax -- carry qword out of the top
+asm_addmul_1:
+                mov             r8, rdx
+                xor             r9d, r9d
+                test            r8, r8
+                jz              .done
+
+                lea             rsi, [rsi + 8 * r8]
+                lea             rdi, [rdi + 8 * r8]
+                neg             r8
+.loop:
+                mov             rax, [rsi + 8 * r8]
+                mul             rcx
+                add             rax, r9
+                adc             rdx, 0
+                add             [rdi + 8 * r8], rax
+                adc             rdx, 0
+                mov             r9, rdx
+                inc             r8
+                jnz             .loop
+
+.done:
+                mov             rax, r9
+                ret
+
+; subtracts the product of a long number and a short from the result
+;    rdi -- address of the result (long number)
+;    rsi -- address of multiplier #1 (long number)
+;    rdx -- length of long numbers in qwords
+;    rcx -- multiplier #2 (64-bit unsigned)
+; result:
+;    rax -- borrow qword out of the top
+asm_submul_1:
+                mov             r8, rdx
+                xor             r9d, r9d
+                test            r8, r8
+                jz              .done
+
+                lea             rsi, [rsi + 8 * r8]
+                lea             rdi, [rdi + 8 * r8]
+                neg             r8
+.loop:
+                mov             rax, [rsi + 8 * r8]
+                mul             rcx
+                add             rax, r9
+                adc             rdx, 0
+                sub             [rdi + 8 * r8], rax
+                adc             rdx, 0
+                mov             r9, rdx
+                inc             r8
+                jnz             .loop
+
+.done:
+                mov             rax, r9
+                ret
+
+; divides long number by a short
+;    rdi -- address of the quotient
+;    rsi -- address of the dividend (long number)
+;    rdx -- length of long number in qwords
+;    rcx -- divisor (64-bit unsigned)
+; result:
+;    rax -- remainder
+asm_divrem_1:
+                mov             r8, rdx
+                xor             edx, edx
+                test            r8, r8
+                jz              .done
+
+.loop:
+                mov             rax, [rsi + 8 * r8 - 8]
+                div             rcx
+                mov             [rdi + 8 * r8 - 8], rax
+                dec             r8
+                jnz             .loop
+
+.done:
+                mov             rax, rdx
+                ret
+
+                section         .note.GNU-stack noalloc noexec nowrite progbits
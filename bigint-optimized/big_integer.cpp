@@ -1,34 +1,124 @@
 #include "big_integer.h"
+#include "limb_arithmetic.h"
+
+#include <cmath>
+#include <map>
+
+namespace {
+constexpr size_t TO_STRING_THRESHOLD = 30;
+constexpr size_t FROM_STRING_THRESHOLD = 30;
+constexpr limb_t DECIMAL_BASE = 10000000000000000000u;
+constexpr size_t DECIMAL_BASE_DIGITS = 19;
+constexpr uint32_t BINOMIAL_SIEVE_RATIO = 128;
+
+char const DIGIT_PAIRS[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// writes the DECIMAL_BASE_DIGITS digits of x right before end
+void write_chunk(char *end, limb_t x)
+{
+    for (size_t i = 0; i < DECIMAL_BASE_DIGITS / 2; i++) {
+        size_t pair = static_cast<size_t>(x % 100) * 2;
+        x /= 100;
+        *--end = DIGIT_PAIRS[pair + 1];
+        *--end = DIGIT_PAIRS[pair];
+    }
+    *--end = static_cast<char>('0' + x);
+}
+}
 
-const big_integer ZERO = big_integer(0);
+// DECIMAL_BASE^(2^k) and reciprocals of the large ones, built on demand;
+// every conversion builds its own, so nothing is shared between threads
+// or kept after it returns
+struct big_integer::decimal_ladder
+{
+    big_integer power(size_t k)
+    {
+        if (powers.empty()) {
+            powers.emplace_back(static_cast<size_t>(1));
+            powers[0].digits[0] = DECIMAL_BASE;
+        }
+        while (powers.size() <= k) {
+            powers.push_back(square(powers.back()));
+        }
+        return powers[k];
+    }
+
+    // both halves of a split are split again at the same smaller powers
+    reciprocal const &inverse(size_t k)
+    {
+        auto it = inverses.find(k);
+        if (it == inverses.end()) {
+            big_integer const p = power(k);
+            it = inverses.emplace(k, reciprocal(p.digits.data(), p.digits.size())).first;
+        }
+        return it->second;
+    }
+
+    std::vector<big_integer> powers;
+    std::map<size_t, reciprocal> inverses;
+};
 
 big_integer::big_integer() : digits(0), sign(false) {}
 
 big_integer::big_integer(int x) : sign(x < 0)
 {
-    digits.push_back(static_cast<uint32_t>(std::abs(static_cast<int64_t>(x))));
+    digits.push_back(static_cast<limb_t>(std::abs(static_cast<int64_t>(x))));
 }
 
 big_integer::big_integer(size_t sz) : big_integer()
 {
-    for (size_t i = 1; i < sz; i++) {
-        digits.push_back(0);
+    digits.resize(std::max(sz, static_cast<size_t>(1)));
+}
+
+// |value| of a string of decimal digits, DECIMAL_BASE chunks are accumulated
+// directly into limbs and long strings are split at 19 * 2^k low digits
+big_integer big_integer::read_decimal(const char *str, size_t len, decimal_ladder &ladder)
+{
+    if (len > DECIMAL_BASE_DIGITS * FROM_STRING_THRESHOLD) {
+        size_t k = 0;
+        while ((DECIMAL_BASE_DIGITS << (k + 1)) < len) {
+            k++;
+        }
+        size_t low = DECIMAL_BASE_DIGITS << k;
+        return read_decimal(str, len - low, ladder) * ladder.power(k) + read_decimal(str + len - low, low, ladder);
     }
+    size_t chunks = (len + DECIMAL_BASE_DIGITS - 1) / DECIMAL_BASE_DIGITS;
+    big_integer result(chunks);
+    limb_t *r = result.digits.data();
+    size_t n = 0, pos = 0, next = len - (chunks - 1) * DECIMAL_BASE_DIGITS;
+    for (size_t i = 0; i < chunks; i++, next += DECIMAL_BASE_DIGITS) {
+        limb_t value = 0;
+        for (; pos < next; pos++) {
+            value = value * 10 + static_cast<limb_t>(str[pos] - '0');
+        }
+        limb_t carry = mul_1(r, r, n, DECIMAL_BASE);
+        carry += add_1(r, r, n, value);
+        if (carry != 0) {
+            r[n++] = carry;
+        }
+    }
+    result.digits.resize(std::max(n, static_cast<size_t>(1)));
+    return result;
 }
 
 big_integer::big_integer(const std::string &str) : big_integer()
 {
     size_t pos = (str[0] == '+' || str[0] == '-' ? 1 : 0);
     for (size_t i = pos; i < str.length(); i++) {
-        if ('0' <= str[i] && str[i] <= '9') {
-            *this *= 10;
-            *this += (str[i] - '0');
-        } else {
+        if (str[i] < '0' || '9' < str[i]) {
             throw std::invalid_argument("String is not a number");
         }
     }
-    sign = (*this == ZERO ? false : str[0] == '-');
-    delete_zeros();
+    if (pos < str.length()) {
+        decimal_ladder ladder;
+        *this = read_decimal(str.data() + pos, str.length() - pos, ladder);
+    }
+    sign = !is_zero() && str[0] == '-';
 }
 
 big_integer::big_integer(uint32_t x) : sign(false)
@@ -36,6 +126,12 @@ big_integer::big_integer(uint32_t x) : sign(false)
     digits.push_back(x);
 }
 
+// the moved-from value is left equal to zero
+big_integer::big_integer(big_integer &&other) noexcept : big_integer()
+{
+    swap(other);
+}
+
 big_integer &big_integer::operator=(const big_integer &second)
 {
     big_integer tmp(second);
@@ -43,54 +139,137 @@ big_integer &big_integer::operator=(const big_integer &second)
     return *this;
 }
 
+big_integer &big_integer::operator=(big_integer &&second) noexcept
+{
+    swap(second);
+    return *this;
+}
+
 big_integer &big_integer::operator+=(const big_integer &x)
 {
-    return *this = *this + x;
+    return add_signed(x, x.sign);
 }
 
 big_integer &big_integer::operator-=(const big_integer &x)
 {
-    return *this = *this - x;
+    return add_signed(x, !x.sign);
 }
 
 big_integer &big_integer::operator*=(const big_integer &x)
 {
-    return *this = *this * x;
+    if (x.digits.size() != 1) {
+        big_integer product = (this == &x ? square(x) : *this * x);
+        swap(product);
+        return *this;
+    }
+    limb_t m = x.digits[0];
+    bool negative = sign ^ x.sign;
+    limb_t carry = mul_1(digits.data(), digits.data(), digits.size(), m);
+    if (carry != 0) {
+        digits.push_back(carry);
+    }
+    delete_zeros();
+    sign = negative && !is_zero();
+    return *this;
 }
 
 big_integer &big_integer::operator/=(const big_integer &x)
 {
-    return *this = *this / x;
+    if (x.digits.size() != 1) {
+        big_integer quotient = divmod(*this, x).first;
+        swap(quotient);
+        return *this;
+    }
+    limb_t d = x.digits[0];
+    bool negative = sign ^ x.sign;
+    divrem_1(digits.data(), digits.data(), digits.size(), d);
+    delete_zeros();
+    sign = negative && !is_zero();
+    return *this;
 }
 
 big_integer &big_integer::operator%=(const big_integer &x)
 {
-    return *this = *this % x;
+    if (x.digits.size() != 1) {
+        big_integer remainder = divmod(*this, x).second;
+        swap(remainder);
+        return *this;
+    }
+    limb_t rem = divrem_1(digits.data(), digits.data(), digits.size(), x.digits[0]);
+    digits.resize(1);
+    digits[0] = rem;
+    sign = sign && rem != 0;
+    return *this;
 }
 
 big_integer &big_integer::operator&=(const big_integer &x)
 {
-    return *this = *this & x;
+    return apply_bitwise<bit_and>(x);
 }
 
 big_integer &big_integer::operator|=(const big_integer &x)
 {
-    return *this = *this | x;
+    return apply_bitwise<bit_or>(x);
 }
 
 big_integer &big_integer::operator^=(const big_integer &x)
 {
-    return *this = *this ^ x;
+    return apply_bitwise<bit_xor>(x);
 }
 
-big_integer &big_integer::operator<<=(int x)
+big_integer &big_integer::operator<<=(int shift)
 {
-    return *this = *this << x;
+    if (shift < 0) {
+        return *this >>= -shift;
+    }
+    if (is_zero()) {
+        return *this;
+    }
+    size_t words = static_cast<size_t>(shift) / LIMB_BITS, n = digits.size();
+    unsigned bits = static_cast<unsigned>(shift) % LIMB_BITS;
+    digits.resize(n + words + 1);
+    limb_t *r = digits.data();
+    if (bits != 0) {
+        r[n + words] = lshift(r + words, r, n, bits);
+    } else {
+        std::copy_backward(r, r + n, r + n + words);
+    }
+    std::fill(r, r + words, 0);
+    delete_zeros();
+    return *this;
 }
 
-big_integer &big_integer::operator>>=(int x)
+// rounds toward negative infinity: a negative value whose shifted out
+// bits are not all zero moves one further away from zero
+big_integer &big_integer::operator>>=(int shift)
 {
-    return *this = *this >> x;
+    if (shift < 0) {
+        return *this <<= -shift;
+    }
+    size_t words = static_cast<size_t>(shift) / LIMB_BITS, n = digits.size();
+    unsigned bits = static_cast<unsigned>(shift) % LIMB_BITS;
+    limb_t *r = digits.data();
+    bool sticky = false;
+    for (size_t i = 0; i < std::min(words, n) && !sticky; i++) {
+        sticky = (r[i] != 0);
+    }
+    if (words >= n) {
+        digits.resize(1);
+        digits[0] = 0;
+    } else {
+        if (bits != 0) {
+            sticky |= (rshift(r, r + words, n - words, bits) != 0);
+        } else {
+            std::copy(r + words, r + n, r);
+        }
+        digits.resize(n - words);
+        delete_zeros();
+    }
+    if (sign && sticky && add_1(digits.data(), digits.data(), digits.size(), 1) != 0) {
+        digits.push_back(1);
+    }
+    sign = sign && !is_zero();
+    return *this;
 }
 
 big_integer big_integer::operator+() const
@@ -115,7 +294,7 @@ big_integer &big_integer::operator--()
 
 big_integer big_integer::operator-() const
 {
-    if (*this == ZERO) {
+    if (is_zero()) {
         return *this;
     }
     big_integer res(*this);
@@ -123,320 +302,692 @@ big_integer big_integer::operator-() const
     return res;
 }
 
-//"+", "-", "*" were taken from emaxx and "/" -- from https://surface.syr.edu/cgi/viewcontent.cgi?article=1162&context=eecs_techreports
+//"+", "-", "*" were taken from emaxx and "/" -- from
+// https://surface.syr.edu/cgi/viewcontent.cgi?article=1162&context=eecs_techreports
 
 big_integer operator+(big_integer a, const big_integer &b)
 {
-    if (a.sign != b.sign) {
-        return (a.sign ? b - (-a) : a - (-b));
-    }
-    size_t sz = std::max(a.digits.size(), b.digits.size());
-    big_integer result(sz);
-    bool carry = false;
-    uint64_t sum;
-    for (size_t  i = 0; i < sz; i++) {
-        sum = (carry ? 1 : 0);
-        if (i < a.digits.size()) {
-            sum += a.digits[i];
-        }
-        if (i < b.digits.size()) {
-            sum += b.digits[i];
-        }
-        carry = (sum > UINT32_MAX);
-        result.digits[i] = static_cast<uint32_t>(sum & UINT32_MAX);
+    a += b;
+    return a;
+}
+
+big_integer operator+(const big_integer &a, big_integer &&b)
+{
+    b += a;
+    return std::move(b);
+}
+
+big_integer operator-(big_integer a, const big_integer &b)
+{
+    a -= b;
+    return a;
+}
+
+big_integer operator-(const big_integer &a, big_integer &&b)
+{
+    if (&a == &b) {
+        return big_integer();
     }
-    if (carry) {
-        result.digits.push_back(1);
+    b.sign = !b.sign && !b.is_zero();
+    b += a;
+    return std::move(b);
+}
+
+big_integer operator*(big_integer a, const big_integer &b)
+{
+    // a copy of b, as made for x * x and x *= x, still shares its limbs
+    if (a.digits.shares_buffer(b.digits)) {
+        big_integer result = square(a);
+        result.sign = !result.is_zero() && (a.sign ^ b.sign);
+        return result;
     }
-    result.sign = a.sign;
+    big_integer const &x = (a.digits.size() >= b.digits.size() ? a : b);
+    big_integer const &y = (a.digits.size() >= b.digits.size() ? b : a);
+    big_integer result(x.digits.size() + y.digits.size());
+    mul(result.digits.data(), x.digits.data(), x.digits.size(), y.digits.data(), y.digits.size());
     result.delete_zeros();
+    result.sign = !result.is_zero() && (a.sign ^ b.sign);
     return result;
 }
 
-big_integer operator-(big_integer a, const big_integer &b)
+std::pair<big_integer, big_integer> divmod(const big_integer &a, const big_integer &b)
 {
-    if (a.sign != b.sign) {
-        return (a.sign ? -(-a + b) : a + (-b));
+    size_t an = a.digits.size(), bn = b.digits.size();
+    if (an < bn || (an == bn && compare_n(a.digits.data(), b.digits.data(), an) < 0)) {
+        return std::make_pair(big_integer(0), a);
     }
-    if (a.sign) {
-        return -b - (-a);
+    big_integer quotient(an - bn + 1), remainder(bn);
+    divrem(quotient.digits.data(), remainder.digits.data(), a.digits.data(), an, b.digits.data(), bn);
+    quotient.delete_zeros();
+    remainder.delete_zeros();
+    quotient.sign = a.sign ^ b.sign;
+    remainder.sign = a.sign && (remainder.digits.size() > 1 || remainder.digits[0] != 0);
+    return std::make_pair(quotient, remainder);
+}
+
+big_integer square(big_integer const &a)
+{
+    big_integer result(2 * a.digits.size());
+    sqr(result.digits.data(), a.digits.data(), a.digits.size());
+    result.delete_zeros();
+    return result;
+}
+
+big_integer powmod(big_integer const &base, big_integer const &exp, big_integer const &mod)
+{
+    if (mod.is_zero()) {
+        throw std::invalid_argument("Modulus is zero");
     }
-    if (a < b) {
-        return -(b - a);
+    if (exp.sign) {
+        throw std::invalid_argument("Exponent is negative");
     }
-    bool carry = false;
-    int64_t subtract;
-    big_integer result(a.digits.size());
-    for (size_t i = 0; i < a.digits.size(); i++) {
-        subtract = a.digits[i];
-        if (carry) {
-            subtract--;
-        }
-        if (i < b.digits.size()) {
-            subtract -= b.digits[i];
-        }
-        carry = (subtract < 0);
-        result.digits[i] = static_cast<uint32_t>(subtract);
+    if (exp.is_zero()) {
+        return big_integer(1) % mod;
     }
+    size_t n = mod.digits.size();
+    big_integer result(n);
+    powmod(result.digits.data(), base.digits.data(), base.digits.size(), exp.digits.data(), exp.digits.size(),
+           mod.digits.data(), n);
     result.delete_zeros();
+    // (-a)^e = -(a^e) for odd e
+    if (base.sign && (exp.digits[0] & 1) != 0 && !result.is_zero()) {
+        result.sign = true;
+        result += (mod.sign ? -mod : mod);
+    }
     return result;
 }
 
-big_integer operator*(big_integer a, const big_integer &b)
+// The trailing zero bits of the base come out as a shift of the result,
+// so powers of two take no multiplication at all. The odd part is raised
+// in place inside the result, which is allocated once at its final size.
+big_integer pow(big_integer const &base, int exp)
 {
-    size_t sz = a.digits.size() + b.digits.size();
-    big_integer result(sz);
-    for (size_t i = 0; i < a.digits.size(); i++) {
-        uint32_t carry = 0;
-        for (size_t j = 0; j < b.digits.size() || carry; j++) {
-            uint64_t mult = result.digits[i + j] + static_cast<uint64_t>(a.digits[i]) * (j < b.digits.size() ? b.digits[j] : 0) + carry;
-            result.digits[i + j] = static_cast<uint32_t>(mult & UINT32_MAX);
-            carry = static_cast<uint32_t>(mult >> 32);
-        }
+    if (exp < 0) {
+        throw std::invalid_argument("Exponent is negative");
+    }
+    if (exp == 0) {
+        return 1;
+    }
+    if (base.is_zero()) {
+        return base;
+    }
+    limb_t e = static_cast<limb_t>(exp);
+    size_t zero_limbs = 0;
+    while (base.digits[zero_limbs] == 0) {
+        zero_limbs++;
+    }
+    unsigned zero_bits = static_cast<unsigned>(__builtin_ctzll(base.digits[zero_limbs]));
+    size_t an = base.digits.size() - zero_limbs;
+    std::vector<limb_t> a(base.digits.data() + zero_limbs, base.digits.data() + zero_limbs + an);
+    if (zero_bits != 0) {
+        rshift(a.data(), a.data(), an, zero_bits);
+        an -= (a[an - 1] == 0);
+    }
+    size_t bits = an * LIMB_BITS - static_cast<size_t>(__builtin_clzll(a[an - 1]));
+    size_t shift = (zero_limbs * LIMB_BITS + zero_bits) * e;
+
+    size_t rn = e * bits / LIMB_BITS + 2;
+    big_integer result(shift / LIMB_BITS + rn + 1);
+    limb_t *r = result.digits.data() + shift / LIMB_BITS;
+    size_t n = 1;
+    if (bits == 1) {
+        r[0] = 1;
+    } else {
+        std::vector<limb_t> scratch(rn);
+        n = pow(r, a.data(), an, e, scratch.data());
+        std::fill(r + n, r + rn + 1, 0);
+    }
+    if (shift % LIMB_BITS != 0) {
+        r[n] = lshift(r, r, n, shift % LIMB_BITS);
     }
     result.delete_zeros();
-    result.sign = (result == ZERO ? false : a.sign ^ b.sign);
+    result.sign = base.sign && exp % 2 == 1;
     return result;
 }
 
-uint32_t trial(uint64_t a, uint64_t b, uint64_t c)
+big_integer gcd(big_integer const &a, big_integer const &b)
 {
-    return std::min(static_cast<uint32_t>(((a << 32) + b) / c), UINT32_MAX);
+    if (a.is_zero() || b.is_zero()) {
+        big_integer result = (a.is_zero() ? b : a);
+        result.sign = false;
+        return result;
+    }
+    big_integer const &x = (a.digits.size() >= b.digits.size() ? a : b);
+    big_integer const &y = (a.digits.size() >= b.digits.size() ? b : a);
+    big_integer result(y.digits.size());
+    gcd(result.digits.data(), x.digits.data(), x.digits.size(), y.digits.data(), y.digits.size());
+    result.delete_zeros();
+    return result;
 }
 
-big_integer short_div(const big_integer &a, uint32_t b)
+std::tuple<big_integer, big_integer, big_integer> gcdext(big_integer const &a, big_integer const &b)
 {
-    big_integer result;
-    uint64_t carry = 0;
-    for (int i = static_cast<int>(a.digits.size()) - 1; i >= 0; i--) {
-        uint64_t cur = (carry << 32) | a.digits[i];
-        result.digits.push_back(static_cast<uint32_t>(cur / b));
-        carry = cur % b;
+    if (a.is_zero() || b.is_zero()) {
+        int s = (a.is_zero() ? 0 : a.sign ? -1 : 1);
+        int t = (!a.is_zero() || b.is_zero() ? 0 : b.sign ? -1 : 1);
+        return std::make_tuple(gcd(a, b), big_integer(s), big_integer(t));
     }
-    result.digits.reverse();
-    result.delete_zeros();
-    return result;
+    bool swapped = (a.digits.size() < b.digits.size());
+    big_integer const &x = (swapped ? b : a);
+    big_integer const &y = (swapped ? a : b);
+    big_integer g(y.digits.size()), t(x.digits.size());
+    ptrdiff_t tn;
+    gcdext(g.digits.data(), t.digits.data(), &tn, x.digits.data(), x.digits.size(), y.digits.data(), y.digits.size());
+    g.delete_zeros();
+    t.delete_zeros();
+    t.sign = !t.is_zero() && ((tn < 0) ^ y.sign);
+    big_integer other = (g - t * y) / x;
+    big_integer s = (swapped ? t : other), u = (swapped ? other : t);
+
+    // s is unique modulo |b| / g, the cofactors out of Euclid's algorithm
+    // are nearly always in range already
+    big_integer k = b / g, twice = s * 2;
+    k.sign = false;
+    twice.sign = false;
+    if (k == 2 || twice > k) {
+        if (k == 2) {
+            s = (a.sign ? -1 : 1);
+        } else {
+            s %= k;
+            twice = s * 2;
+            if (twice > k) {
+                s -= k;
+            } else if (twice < -k) {
+                s += k;
+            }
+        }
+        u = (g - s * a) / b;
+    }
+    return std::make_tuple(g, s, u);
+}
+
+big_integer invert(big_integer const &a, big_integer const &mod)
+{
+    if (mod.is_zero()) {
+        throw std::invalid_argument("Modulus is zero");
+    }
+    big_integer m = mod;
+    m.sign = false;
+    big_integer x = a % m;
+    if (x.sign) {
+        x += m;
+    }
+    if (x.is_zero()) {
+        if (m != 1) {
+            throw std::invalid_argument("Value is not invertible");
+        }
+        return x;
+    }
+    big_integer g(x.digits.size()), t(m.digits.size());
+    ptrdiff_t tn;
+    gcdext(g.digits.data(), t.digits.data(), &tn, m.digits.data(), m.digits.size(), x.digits.data(), x.digits.size());
+    g.delete_zeros();
+    t.delete_zeros();
+    if (g != 1) {
+        throw std::invalid_argument("Value is not invertible");
+    }
+    return (tn < 0 ? m - t : t);
+}
+
+// The root of x >> kh, shifted back by h bits and plus one, is at most
+// 2^h above floor(x^(1/k)); one Newton step from there brings the error
+// below 1/8 when 2h stays a few bits under the size of the root less the
+// size of k. The recursion halves the working precision down to a
+// floating-point seed out of the top two limbs.
+big_integer iroot(big_integer const &x, int k)
+{
+    if (k <= 0) {
+        throw std::invalid_argument("Root degree is not positive");
+    }
+    if (x.sign) {
+        if (k % 2 == 0) {
+            throw std::invalid_argument("Even root of a negative number");
+        }
+        return -iroot(-x, k);
+    }
+    if (x.is_zero() || k == 1) {
+        return x;
+    }
+    unsigned degree = static_cast<unsigned>(k);
+    size_t n = x.digits.size();
+    size_t bits = n * LIMB_BITS - static_cast<size_t>(__builtin_clzll(x.digits[n - 1]));
+    size_t root_bits = (bits + degree - 1) / degree;
+    size_t degree_bits = 32 - static_cast<size_t>(__builtin_clz(degree));
+
+    big_integer y;
+    if (root_bits <= 32 || root_bits < degree_bits + 8) {
+        double top = static_cast<double>(x.digits[n - 1]);
+        double log2x = std::log2(top) + static_cast<double>((n - 1) * LIMB_BITS);
+        if (n > 1) {
+            top = std::ldexp(top, LIMB_BITS) + static_cast<double>(x.digits[n - 2]);
+            log2x = std::log2(top) + static_cast<double>((n - 2) * LIMB_BITS);
+        }
+        y = big_integer(static_cast<size_t>(1));
+        y.digits[0] = static_cast<limb_t>(std::exp2(log2x / degree));
+        while (!y.is_zero() && pow(y, k) > x) {
+            y -= 1;
+        }
+        while (pow(y + 1, k) <= x) {
+            y += 1;
+        }
+        return y;
+    }
+    size_t h = (root_bits - degree_bits) / 2 - 2;
+    y = (iroot(x >> static_cast<int>(degree * h), k) + 1) << static_cast<int>(h);
+    y = (y * (k - 1) + x / pow(y, k - 1)) / k;
+    while (pow(y, k) > x) {
+        y -= 1;
+    }
+    return y;
+}
+
+big_integer isqrt(big_integer const &x)
+{
+    if (x.sign) {
+        throw std::invalid_argument("Square root of a negative number");
+    }
+    return iroot(x, 2);
 }
 
-void difference(big_integer &a, const big_integer &b, size_t k, size_t m)
+big_integer product(std::vector<big_integer> factors)
 {
-    bool carry = false;
-    for (size_t i = 0; i < m; i++) {
-        uint32_t first = a.digits[i + k - 1];
-        uint32_t second = (i < b.digits.size() ? b.digits[i] : 0);
-        uint64_t cur = static_cast<int64_t>(first) - second - carry;
-        carry = (second + carry > first);
-        cur &= UINT32_MAX;
-        a.digits[i + k - 1] = static_cast<uint32_t>(cur);
+    if (factors.empty()) {
+        return 1;
+    }
+    while (factors.size() > 1) {
+        size_t half = factors.size() / 2;
+        for (size_t i = 0; i < half; i++) {
+            factors[i] = std::move(factors[2 * i]) * factors[2 * i + 1];
+        }
+        if (factors.size() % 2 != 0) {
+            factors[half++] = std::move(factors.back());
+        }
+        factors.resize(half);
     }
+    return factors[0];
 }
 
-bool smaller(const big_integer &a, const big_integer &b, size_t k, size_t m)
+namespace {
+std::vector<uint32_t> odd_primes(uint32_t n)
 {
-    for (size_t i = m; i != 0; i--) {
-        uint32_t value = (i < b.digits.size() ? b.digits[i] : 0);
-        if (a.digits[i + k - 1] != value) {
-            return a.digits[i + k - 1] < value;
+    std::vector<uint32_t> primes;
+    std::vector<bool> composite(n / 2 + 1);
+    for (uint64_t p = 3; p <= n; p += 2) {
+        if (composite[p / 2]) {
+            continue;
+        }
+        primes.push_back(static_cast<uint32_t>(p));
+        for (uint64_t q = p * p; q <= n; q += 2 * p) {
+            composite[q / 2] = true;
         }
     }
-    return false;
+    return primes;
+}
 }
 
-big_integer operator/(big_integer a, const big_integer &b)
+// runs of factors whose product fits a limb are collapsed before the
+// product tree, so its leaves are full limbs
+big_integer big_integer::limb_product(std::vector<limb_t> const &factors)
+{
+    std::vector<big_integer> leaves;
+    limb_t run = 1;
+    for (limb_t f : factors) {
+        double_limb_t next = static_cast<double_limb_t>(run) * f;
+        if ((next >> LIMB_BITS) == 0) {
+            run = static_cast<limb_t>(next);
+            continue;
+        }
+        leaves.emplace_back(static_cast<size_t>(1));
+        leaves.back().digits[0] = run;
+        run = f;
+    }
+    leaves.emplace_back(static_cast<size_t>(1));
+    leaves.back().digits[0] = run;
+    return product(std::move(leaves));
+}
+
+// The odd part of n! / ((n/2)!)^2 is the product of p^e over the odd
+// primes p <= n, where e counts the odd values among n / p^i; every such
+// p^e is at most n. Everything below 21! fits a limb.
+big_integer big_integer::odd_factorial(uint32_t n, std::vector<uint32_t> const &primes)
+{
+    if (n < 21) {
+        limb_t f = 1;
+        for (limb_t i = 2; i <= n; i++) {
+            f *= i;
+        }
+        return limb_product({f >> __builtin_ctzll(f)});
+    }
+    std::vector<limb_t> swing;
+    for (size_t i = 0; i < primes.size() && primes[i] <= n; i++) {
+        limb_t f = 1;
+        for (uint32_t q = n / primes[i]; q != 0; q /= primes[i]) {
+            if (q % 2 != 0) {
+                f *= primes[i];
+            }
+        }
+        if (f != 1) {
+            swing.push_back(f);
+        }
+    }
+    return square(odd_factorial(n / 2, primes)) * limb_product(swing);
+}
+
+// (n choose k) for k <= n / 2 holds p once for every borrow of n - k - k
+// in base p (Kummer), again with p^e <= n; when k is small next to n the
+// sieve costs more than n (n - 1) ... (n - k + 1) / k!
+big_integer big_integer::binomial_of(uint32_t n, uint32_t k)
 {
-    big_integer first = a, second = b;
-    first.sign = second.sign = false;
-    if (first < second) {
+    if (k > n) {
         return 0;
     }
-    if (second.digits.size() == 1) {
-        big_integer result;
-        result = short_div(first, second.digits[0]);
-        result.sign = a.sign ^ b.sign;
-        return result;
+    k = std::min(k, n - k);
+    if (k < n / BINOMIAL_SIEVE_RATIO) {
+        std::vector<limb_t> factors(k);
+        for (uint32_t i = 0; i < k; i++) {
+            factors[i] = n - i;
+        }
+        return limb_product(factors) / factorial(static_cast<int>(k));
     }
-    uint32_t factor = ((static_cast<uint64_t>(1) << 32)) / (second.digits.back() + 1);
-    first *= factor;
-    second *= factor;
-    first.digits.push_back(0);
-    size_t n = first.digits.size(), m = second.digits.size();
-    big_integer result(n - m), dq;
-    for (size_t i = n - m; i != 0; i--) {
-        uint32_t qt = trial(first.digits[i + m - 1], first.digits[i + m - 2], second.digits[m - 1]);
-        dq = second * qt;
-        while (qt != 0 && smaller(first, dq, i, m)) {
-            qt--;
-            dq -= second;
+    std::vector<limb_t> factors;
+    for (uint32_t p : odd_primes(n)) {
+        limb_t f = 1;
+        for (uint32_t a = n, b = k, c = n - k; a >= p;) {
+            a /= p;
+            b /= p;
+            c /= p;
+            if (a != b + c) {
+                f *= p;
+            }
+        }
+        if (f != 1) {
+            factors.push_back(f);
         }
-        result.digits[i - 1] = qt;
-        difference(first, dq, i, m);
     }
-    result.delete_zeros();
-    result.sign = a.sign ^ b.sign;
-    return result;
+    int twos = __builtin_popcount(k) + __builtin_popcount(n - k) - __builtin_popcount(n);
+    return limb_product(factors) << twos;
 }
 
-big_integer operator>>(big_integer a, int shift)
+// n! = odd_factorial(n) 2^(n - popcount(n))
+big_integer factorial(int n)
 {
-    if (shift < 0) {
-        return a << (-shift);
+    if (n < 0) {
+        throw std::invalid_argument("Factorial of a negative number");
     }
-    a /= static_cast<uint32_t>(1) << (shift % 32);
-    a.digits.reverse();
-    for (int i = 0; i < (shift / 32) && (a.digits.size() != 0); i++) {
-        a.digits.pop_back();
+    uint32_t m = static_cast<uint32_t>(n);
+    return big_integer::odd_factorial(m, odd_primes(m)) << (n - __builtin_popcount(m));
+}
+
+big_integer binomial(int n, int k)
+{
+    if (k < 0) {
+        return 0;
     }
-    a.digits.reverse();
-    if (a.digits.size() == 0) {
-        a = 0;
+    if (n < 0) {
+        uint32_t m = static_cast<uint32_t>(k) + static_cast<uint32_t>(-static_cast<int64_t>(n)) - 1;
+        big_integer result = big_integer::binomial_of(m, static_cast<uint32_t>(k));
+        return (k % 2 == 0 ? result : -result);
     }
-    return (a.sign ? a - 1 : a);
+    return big_integer::binomial_of(static_cast<uint32_t>(n), static_cast<uint32_t>(k));
+}
+
+big_integer operator/(big_integer a, const big_integer &b)
+{
+    return divmod(a, b).first;
+}
+
+big_integer operator>>(big_integer a, int shift)
+{
+    a >>= shift;
+    return a;
 }
 
 big_integer operator<<(big_integer a, int shift)
 {
-    if (shift < 0) {
-        return  a >> (-shift);
+    a <<= shift;
+    return a;
+}
+
+// appends |x| padded with zeros to width digits, or unpadded if width is 0
+void big_integer::write_decimal(std::string &out, const big_integer &x, size_t width, decimal_ladder &ladder)
+{
+    size_t n = x.digits.size();
+    if (n <= TO_STRING_THRESHOLD) {
+        std::vector<limb_t> tmp(x.digits.data(), x.digits.data() + n);
+        std::vector<limb_t> chunks;
+        while (n != 0) {
+            chunks.push_back(divrem_1(tmp.data(), tmp.data(), n, DECIMAL_BASE));
+            n = normalized_size(tmp.data(), n);
+        }
+        std::string buffer(chunks.size() * DECIMAL_BASE_DIGITS, '0');
+        for (size_t i = 0; i < chunks.size(); i++) {
+            write_chunk(&buffer[0] + buffer.size() - i * DECIMAL_BASE_DIGITS, chunks[i]);
+        }
+        size_t start = 0;
+        if (width == 0) {
+            start = std::min(buffer.find_first_not_of('0'), buffer.size() - 1);
+        } else if (width >= buffer.size()) {
+            out.append(width - buffer.size(), '0');
+        } else {
+            start = buffer.size() - width;
+        }
+        out.append(buffer, start, std::string::npos);
+        return;
     }
-    a *= (static_cast<uint32_t>(1) << (shift % 32));
-    a.digits.reverse();
-    for (int i = 0; i < (shift / 32); i++) {
-        a.digits.push_back(0);
+    // the square of a power has at least 2 pn - 1 limbs, which is enough to
+    // pick the split without squaring past the power that gets used
+    size_t k = 0;
+    while (2 * (2 * ladder.power(k).digits.size() - 1) <= n + 1) {
+        k++;
     }
-    a.digits.reverse();
-    return a;
+    big_integer const power = ladder.power(k);
+    size_t pn = power.digits.size();
+    std::pair<big_integer, big_integer> qr;
+    if (pn < DIV_NEWTON_THRESHOLD) {
+        qr = divmod(x, power);
+    } else {
+        qr = std::make_pair(big_integer(n - pn + 1), big_integer(pn));
+        ladder.inverse(k).divrem(qr.first.digits.data(), qr.second.digits.data(), x.digits.data(), n);
+        qr.first.delete_zeros();
+        qr.second.delete_zeros();
+    }
+    big_integer const &quotient = qr.first, &remainder = qr.second;
+    size_t low = DECIMAL_BASE_DIGITS << k;
+    write_decimal(out, quotient, width == 0 ? 0 : width - low, ladder);
+    write_decimal(out, remainder, low, ladder);
 }
 
 std::string to_string(const big_integer &x)
 {
-    if (x == 0) {
-        return "0";
-    }
     std::string result;
-    big_integer tmp(x);
-    while (tmp != 0) {
-        result += static_cast<char>((tmp % 10).digits[0] + '0');
-        tmp /= 10;
-    }
     if (x.sign) {
         result += "-";
     }
-    std::reverse(result.begin(), result.end());
+    big_integer::decimal_ladder ladder;
+    big_integer::write_decimal(result, x, 0, ladder);
     return result;
 }
 
+// sign first, then the limb count, then the limbs from the top; values
+// sharing one heap buffer are equal without looking at it
+int compare(const big_integer &a, const big_integer &b)
+{
+    if (a.sign != b.sign) {
+        return a.sign ? -1 : 1;
+    }
+    size_t n = a.digits.size();
+    int result;
+    if (n != b.digits.size()) {
+        result = (n < b.digits.size() ? -1 : 1);
+    } else if (a.digits.shares_buffer(b.digits)) {
+        result = 0;
+    } else {
+        result = compare_n(a.digits.data(), b.digits.data(), n);
+    }
+    return a.sign ? -result : result;
+}
+
 bool operator>=(const big_integer &a, const big_integer &b)
 {
-    return !(a < b);
+    return compare(a, b) >= 0;
 }
 
 bool operator<=(const big_integer &a, const big_integer &b)
 {
-    return !(a > b);
+    return compare(a, b) <= 0;
 }
 
 bool operator>(const big_integer &a, const big_integer &b)
 {
-    return b < a;
+    return compare(a, b) > 0;
 }
 
 bool operator<(const big_integer &a, const big_integer &b)
 {
-    if (a.sign != b.sign) {
-        return a.sign;
-    } else if (a.sign) {
-        return (-a > -b);
-    } else if (a.digits.size() != b.digits.size()) {
-        return a.digits.size() < b.digits.size();
-    } else {
-        for (int i = static_cast<int>(a.digits.size()) - 1; i >= 0; i--) {
-            if (a.digits[i] != b.digits[i]) {
-                return a.digits[i] < b.digits[i];
-            }
-        }
-        return false;
-    }
+    return compare(a, b) < 0;
 }
 
 bool operator!=(const big_integer &a, const big_integer &b)
 {
-    return !(a == b);
+    return compare(a, b) != 0;
 }
 
 bool operator==(const big_integer &a, const big_integer &b)
 {
-    return (a.sign == b.sign && a.digits == b.digits);
+    return compare(a, b) == 0;
 }
 
-void big_integer::swap(big_integer &second)
+void big_integer::swap(big_integer &second) noexcept
 {
-    std::swap(digits, second.digits);
+    digits.swap(second.digits);
     std::swap(sign, second.sign);
 }
 
-void big_integer::delete_zeros()
+bool big_integer::is_zero() const
 {
-    while (digits.size() > 1 && digits.back() == 0) {
-        digits.pop_back();
-    }
+    return digits.size() == 1 && digits[0] == 0;
 }
 
-void big_integer::addition_to_two(size_t length)
+// |this| +- |x| in the existing buffer, x may alias *this
+big_integer &big_integer::add_signed(const big_integer &x, bool x_sign)
 {
-    assert(length >= digits.size());
-    while (digits.size() != length) {
-        digits.push_back(0);
+    size_t n = digits.size(), m = x.digits.size();
+    if (sign == x_sign) {
+        if (n < m) {
+            digits.resize(m);
+        }
+        limb_t *r = digits.data();
+        limb_t carry = add(r, r, std::max(n, m), x.digits.data(), m);
+        if (carry != 0) {
+            digits.push_back(carry);
+        }
+        return *this;
     }
-    if (sign) {
-        sign = false;
-        for (size_t i = 0; i < digits.size(); i++) {
-            digits[i] = ~digits[i];
+    limb_t const *b = x.digits.data();
+    if (n > m || (n == m && compare_n(digits.data(), b, n) >= 0)) {
+        limb_t *r = digits.data();
+        sub(r, r, n, x.digits.data(), m);
+        delete_zeros();
+        if (is_zero()) {
+            sign = false;
         }
-        *this += 1;
+        return *this;
     }
+    digits.resize(m);
+    limb_t *r = digits.data();
+    b = x.digits.data();
+    limb_t borrow = sub_n(r, b, r, n);
+    sub_1(r + n, b + n, m - n, borrow);
+    delete_zeros();
+    sign = x_sign;
+    return *this;
 }
 
-big_integer abstract_bitwise_operation(big_integer a, const big_integer &b, std::function<uint32_t (uint32_t, uint32_t)> how)
-{
-    big_integer first = a, second = b;
-    big_integer result;
-    size_t sz = std::max(a.digits.size(), b.digits.size());
-    first.addition_to_two(sz);
-    second.addition_to_two(sz);
-    result.addition_to_two(sz);
-    for (size_t i = 0; i < sz; i++) {
-        result.digits[i] = how(first.digits[i], second.digits[i]);
+// two's complement of both operands is produced on the fly, the result
+// is converted back to sign and magnitude in the same pass. The +1 of a
+// negation only travels through the low zero limbs, past them every
+// conversion is a xor with a sign mask and the rest goes to bitwise_n
+template <typename Op>
+big_integer &big_integer::apply_bitwise(const big_integer &x)
+{
+    size_t n = digits.size(), m = x.digits.size(), sz = std::max(n, m);
+    limb_t ma = (sign ? LIMB_MAX : 0), mb = (x.sign ? LIMB_MAX : 0);
+    limb_t mr = Op()(ma, mb);
+    digits.resize(sz);
+    limb_t *r = digits.data();
+    limb_t const *b = x.digits.data();
+    limb_t carry_a = ma & 1, carry_b = mb & 1, carry_r = mr & 1;
+    size_t i = 0;
+    for (; i < sz && (carry_a | carry_b | carry_r) != 0; i++) {
+        limb_t a_i = (r[i] ^ ma) + carry_a;
+        limb_t b_i = ((i < m ? b[i] : 0) ^ mb) + carry_b;
+        carry_a = (a_i < carry_a);
+        carry_b = (b_i < carry_b);
+        limb_t r_i = (Op()(a_i, b_i) ^ mr) + carry_r;
+        carry_r = (r_i < carry_r);
+        r[i] = r_i;
     }
-    if (how(static_cast<uint32_t>(a.sign), static_cast<uint32_t>(b.sign))) {
-        result = -result;
-        result.addition_to_two(sz);
-        result = -result;
+    if (i < m) {
+        bitwise_n<Op>(r + i, r + i, b + i, m - i, ma, mb, mr);
+        i = m;
     }
-    return result;
+    for (; i < sz; i++) {
+        r[i] = Op()(r[i] ^ ma, mb) ^ mr;
+    }
+    if (carry_r != 0) {
+        digits.push_back(1);
+    }
+    delete_zeros();
+    sign = (mr != 0) && !is_zero();
+    return *this;
 }
 
-big_integer operator%(big_integer a, const big_integer &b)
+void big_integer::delete_zeros()
 {
-    return a - (a / b) * b;
+    while (digits.size() > 1 && digits.back() == 0) {
+        digits.pop_back();
+    }
 }
 
-std::function<uint32_t(uint32_t, uint32_t)> _and = [](uint32_t a, uint32_t b) {return a & b;};
-std::function<uint32_t(uint32_t, uint32_t)> _or = [](uint32_t a, uint32_t b) {return a | b;};
-std::function<uint32_t(uint32_t, uint32_t)> _xor = [](uint32_t a, uint32_t b) {return a ^ b;};
+big_integer operator%(big_integer a, const big_integer &b)
+{
+    return divmod(a, b).second;
+}
 
 big_integer operator&(big_integer a, const big_integer &b)
 {
-    return abstract_bitwise_operation(a, b, _and);
+    a &= b;
+    return a;
+}
+
+big_integer operator&(const big_integer &a, big_integer &&b)
+{
+    b &= a;
+    return std::move(b);
 }
 
 big_integer operator|(big_integer a, const big_integer &b)
 {
-    return abstract_bitwise_operation(a, b, _or);
+    a |= b;
+    return a;
+}
+
+big_integer operator|(const big_integer &a, big_integer &&b)
+{
+    b |= a;
+    return std::move(b);
 }
 
 big_integer operator^(big_integer a, const big_integer &b)
 {
-    return abstract_bitwise_operation(a, b, _xor);
+    a ^= b;
+    return a;
+}
+
+big_integer operator^(const big_integer &a, big_integer &&b)
+{
+    b ^= a;
+    return std::move(b);
 }
 
 std::ostream &operator<<(std::ostream &s, big_integer const &a)
@@ -3,8 +3,8 @@
 
 #include <string>
 #include <vector>
-#include <functional>
 #include <utility>
+#include <tuple>
 #include <algorithm>
 #include <cassert>
 #include <iostream>
@@ -15,6 +15,7 @@ class big_integer
 public:
     big_integer();
     big_integer(big_integer const&) = default;
+    big_integer(big_integer &&) noexcept;
     big_integer(int);
     big_integer(size_t);
     big_integer(uint32_t);
@@ -22,6 +23,7 @@ public:
     ~big_integer() = default;
 
     big_integer& operator=(big_integer const&);
+    big_integer& operator=(big_integer &&) noexcept;
 
     big_integer& operator+=(big_integer const&);
     big_integer& operator-=(big_integer const&);
@@ -45,6 +47,8 @@ public:
     big_integer& operator--();
     big_integer operator--(int);
 
+    // negative, zero or positive as a is less than, equal to or greater than b
+    friend int compare(big_integer const&, big_integer const&);
     friend bool operator==(big_integer const&, big_integer const&);
     friend bool operator!=(big_integer const&, big_integer const&);
     friend bool operator<(big_integer const&, big_integer const&);
@@ -53,9 +57,35 @@ public:
     friend bool operator>=(big_integer const&, big_integer const&);
 
     friend big_integer operator+(big_integer, big_integer const&);
+    friend big_integer operator+(big_integer const&, big_integer &&);
     friend big_integer operator-(big_integer, big_integer const&);
+    friend big_integer operator-(big_integer const&, big_integer &&);
     friend big_integer operator*(big_integer, big_integer const&);
+    friend big_integer square(big_integer const&);
+    // base^exp mod |mod| in [0, |mod|), exp must be non-negative
+    friend big_integer powmod(big_integer const&, big_integer const&, big_integer const&);
+    // base^exp for a non-negative exp, 0^0 = 1
+    friend big_integer pow(big_integer const&, int);
+    // non-negative, gcd(0, 0) = 0
+    friend big_integer gcd(big_integer const&, big_integer const&);
+    // (g, s, t) with g = gcd(a, b) = s a + t b, |s| < |b| / 2g and
+    // |t| < |a| / 2g apart from the corner cases, as mpz_gcdext picks them
+    friend std::tuple<big_integer, big_integer, big_integer> gcdext(big_integer const&, big_integer const&);
+    // a^-1 mod |mod| in [0, |mod|), throws if gcd(a, mod) != 1
+    friend big_integer invert(big_integer const&, big_integer const&);
+    // floor(x^(1/k)) for x >= 0, rounded toward zero for odd k and x < 0
+    friend big_integer iroot(big_integer const&, int);
+    friend big_integer isqrt(big_integer const&);
+    // product of all the factors, 1 for none; a balanced product tree keeps
+    // the operands of every multiplication about the same size
+    friend big_integer product(std::vector<big_integer>);
+    // n! for n >= 0 through the prime-swing recursion
+    friend big_integer factorial(int);
+    // n choose k, 0 for k < 0 and (-1)^k (k - n - 1 choose k) for n < 0
+    friend big_integer binomial(int, int);
     friend big_integer operator/(big_integer, big_integer const&);
+    // quotient rounded toward zero and the remainder with the sign of a
+    friend std::pair<big_integer, big_integer> divmod(big_integer const&, big_integer const&);
 
     friend big_integer operator<<(big_integer, int);
     friend big_integer operator>>(big_integer, int);
@@ -63,15 +93,23 @@ public:
     friend std::string to_string(big_integer const&);
 
 private:
-    void swap(big_integer &);
+    void swap(big_integer &) noexcept;
+    bool is_zero() const;
     void delete_zeros();
-    void addition_to_two(size_t);
+    big_integer& add_signed(big_integer const&, bool);
+    template <typename Op> big_integer& apply_bitwise(big_integer const&);
 
-    friend big_integer abstract_bitwise_operation(big_integer, big_integer const&, std::function<uint32_t(uint32_t, uint32_t)>);
-    friend bool smaller(big_integer const&, big_integer const&, size_t, size_t);
-    friend void difference(big_integer &, big_integer const&, size_t, size_t);
-    friend big_integer short_div(big_integer const&, uint32_t);
-    friend uint32_t trial(uint64_t, uint64_t, uint64_t);
+    // powers of the decimal base shared by the levels of one conversion
+    struct decimal_ladder;
+    static big_integer read_decimal(char const *, size_t, decimal_ladder &);
+    static void write_decimal(std::string &, big_integer const&, size_t, decimal_ladder &);
+
+    // product trees over factors of at most a limb for factorial and binomial
+    static big_integer limb_product(std::vector<limb_t> const&);
+    static big_integer odd_factorial(uint32_t, std::vector<uint32_t> const&);
+    static big_integer binomial_of(uint32_t, uint32_t);
+
+    friend class modulus;
 
     optimized_container digits;
     bool sign;
@@ -80,8 +118,23 @@ private:
 big_integer operator%(big_integer, big_integer const&);
 
 big_integer operator&(big_integer, big_integer const&);
+big_integer operator&(big_integer const&, big_integer &&);
 big_integer operator|(big_integer, big_integer const&);
+big_integer operator|(big_integer const&, big_integer &&);
 big_integer operator^(big_integer, big_integer const&);
+big_integer operator^(big_integer const&, big_integer &&);
+
+big_integer square(big_integer const&);
+big_integer powmod(big_integer const&, big_integer const&, big_integer const&);
+big_integer pow(big_integer const&, int);
+big_integer gcd(big_integer const&, big_integer const&);
+std::tuple<big_integer, big_integer, big_integer> gcdext(big_integer const&, big_integer const&);
+big_integer invert(big_integer const&, big_integer const&);
+big_integer iroot(big_integer const&, int);
+big_integer isqrt(big_integer const&);
+big_integer product(std::vector<big_integer>);
+big_integer factorial(int);
+big_integer binomial(int, int);
 
 std::string to_string(big_integer const&);
 std::ostream &operator<<(std::ostream &, big_integer const &);
@@ -183,6 +183,63 @@ bool operator>=(big_integer_gmp const& a, big_integer_gmp const& b) {
   return mpz_cmp(a.mpz, b.mpz) >= 0;
 }
 
+big_integer_gmp powmod(big_integer_gmp const& base, big_integer_gmp const& exp, big_integer_gmp const& mod) {
+  big_integer_gmp result;
+  mpz_powm(result.mpz, base.mpz, exp.mpz, mod.mpz);
+  return result;
+}
+
+big_integer_gmp pow(big_integer_gmp const& base, int exp) {
+  big_integer_gmp result;
+  mpz_pow_ui(result.mpz, base.mpz, static_cast<unsigned long>(exp));
+  return result;
+}
+
+big_integer_gmp gcd(big_integer_gmp const& a, big_integer_gmp const& b) {
+  big_integer_gmp result;
+  mpz_gcd(result.mpz, a.mpz, b.mpz);
+  return result;
+}
+
+std::tuple<big_integer_gmp, big_integer_gmp, big_integer_gmp> gcdext(big_integer_gmp const& a,
+                                                                     big_integer_gmp const& b) {
+  big_integer_gmp g, s, t;
+  mpz_gcdext(g.mpz, s.mpz, t.mpz, a.mpz, b.mpz);
+  return std::make_tuple(g, s, t);
+}
+
+big_integer_gmp invert(big_integer_gmp const& a, big_integer_gmp const& mod) {
+  big_integer_gmp result;
+  mpz_invert(result.mpz, a.mpz, mod.mpz);
+  return result;
+}
+
+big_integer_gmp iroot(big_integer_gmp const& a, int k) {
+  big_integer_gmp result;
+  mpz_root(result.mpz, a.mpz, k);
+  return result;
+}
+
+big_integer_gmp isqrt(big_integer_gmp const& a) {
+  big_integer_gmp result;
+  mpz_sqrt(result.mpz, a.mpz);
+  return result;
+}
+
+big_integer_gmp big_integer_gmp::factorial(int n) {
+  big_integer_gmp result;
+  mpz_fac_ui(result.mpz, static_cast<unsigned long>(n));
+  return result;
+}
+
+big_integer_gmp big_integer_gmp::binomial(int n, int k) {
+  big_integer_gmp result;
+  if (k >= 0) {
+    mpz_bin_ui(result.mpz, big_integer_gmp(n).mpz, static_cast<unsigned long>(k));
+  }
+  return result;
+}
+
 std::string to_string(big_integer_gmp const& a) {
   char* tmp = mpz_get_str(NULL, 10, a.mpz);
   std::string res = tmp;
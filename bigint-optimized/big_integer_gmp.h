@@ -4,6 +4,8 @@
 #include <cstddef>
 #include <gmp.h>
 #include <iosfwd>
+#include <tuple>
+#include <vector>
 
 struct big_integer_gmp {
   big_integer_gmp();
@@ -24,6 +26,19 @@ struct big_integer_gmp {
     return *this;
   }
 
+  template<typename Limb>
+  big_integer_gmp& import_limbs(std::vector<Limb> const& limbs) {
+    mpz_import(mpz, limbs.size(), -1, sizeof(Limb), 0, 0, limbs.data());
+    return *this;
+  }
+
+  template<typename Limb>
+  std::vector<Limb> export_limbs(size_t sz) const {
+    std::vector<Limb> result(sz);
+    mpz_export(result.data(), nullptr, -1, sizeof(Limb), 0, 0, mpz);
+    return result;
+  }
+
   ~big_integer_gmp();
 
   big_integer_gmp& operator=(big_integer_gmp const& other);
@@ -58,6 +73,18 @@ struct big_integer_gmp {
   friend bool operator<=(big_integer_gmp const& a, big_integer_gmp const& b);
   friend bool operator>=(big_integer_gmp const& a, big_integer_gmp const& b);
 
+  friend big_integer_gmp powmod(big_integer_gmp const& base, big_integer_gmp const& exp, big_integer_gmp const& mod);
+  friend big_integer_gmp pow(big_integer_gmp const& base, int exp);
+  friend big_integer_gmp gcd(big_integer_gmp const& a, big_integer_gmp const& b);
+  friend std::tuple<big_integer_gmp, big_integer_gmp, big_integer_gmp> gcdext(big_integer_gmp const& a,
+                                                                              big_integer_gmp const& b);
+  friend big_integer_gmp invert(big_integer_gmp const& a, big_integer_gmp const& mod);
+  friend big_integer_gmp iroot(big_integer_gmp const& a, int k);
+  friend big_integer_gmp isqrt(big_integer_gmp const& a);
+  // no big_integer_gmp argument to pick the overload by
+  static big_integer_gmp factorial(int n);
+  static big_integer_gmp binomial(int n, int k);
+
   friend std::string to_string(big_integer_gmp const& a);
 
  private:
@@ -2,12 +2,15 @@
 #include <cassert>
 #include <cstdlib>
 #include <random>
+#include <thread>
 #include <vector>
 #include <utility>
 #include <gtest/gtest.h>
 
 #include "big_integer.h"
 #include "big_integer_gmp.h"
+#include "limb_arithmetic.h"
+#include "modulus.h"
 
 TEST(correctness, two_plus_two) {
   EXPECT_EQ(big_integer(4), big_integer(2) + big_integer(2));
@@ -119,6 +122,22 @@ TEST(correctness, add_signed) {
   EXPECT_TRUE(a == -15);
 }
 
+TEST(correctness, compare_three_way) {
+  big_integer a("123456789012345678901234567890123456789012345678901234567890");
+  big_integer b = a;
+  big_integer c = a + 1;
+
+  EXPECT_EQ(0, compare(a, b));
+  EXPECT_GT(0, compare(a, c));
+  EXPECT_LT(0, compare(c, a));
+  EXPECT_LT(0, compare(-a, -c));
+  EXPECT_GT(0, compare(-a, big_integer(1)));
+  EXPECT_LT(0, compare(a, -c));
+  EXPECT_GT(0, compare(-(a * a), -a));
+  EXPECT_EQ(0, compare(big_integer(0), -big_integer(0)));
+  EXPECT_TRUE(-c < -a && -a <= -a && -a >= -c && -a > -c);
+}
+
 TEST(correctness, add_return_value) {
   big_integer a = 5;
   big_integer b = 1;
@@ -127,6 +146,61 @@ TEST(correctness, add_return_value) {
   EXPECT_EQ(7, a);
 }
 
+TEST(correctness, compound_self) {
+  big_integer a("-123456789012345678901234567890");
+  big_integer b = a;
+
+  a += a;
+  EXPECT_EQ(b * 2, a);
+  a -= a;
+  EXPECT_EQ(0, a);
+  a = b;
+  a *= a;
+  EXPECT_EQ(b * b, a);
+  a = b;
+  a &= a;
+  EXPECT_EQ(b, a);
+  a ^= a;
+  EXPECT_EQ(0, a);
+  EXPECT_EQ(b, b / 7 * 7 + b % 7);
+}
+
+TEST(correctness, compound_shared) {
+  big_integer a("123456789012345678901234567890123456789012345678901234567890");
+  big_integer b = a, c = a;
+
+  a += 1;
+  b <<= 40;
+  c >>= 40;
+  EXPECT_EQ(big_integer("123456789012345678901234567890123456789012345678901234567891"), a);
+  EXPECT_EQ(big_integer("135742175046962388768696238876869623887686962388768696238876733881712640"), b);
+  EXPECT_EQ(big_integer("112283295504626656930881443158908456815890845681"), c);
+}
+
+TEST(correctness, move) {
+  big_integer a("123456789012345678901234567890");
+  big_integer b = std::move(a);
+
+  EXPECT_EQ(big_integer("123456789012345678901234567890"), b);
+  EXPECT_EQ(0, a);
+  a = std::move(b);
+  EXPECT_EQ(big_integer("123456789012345678901234567890"), a);
+}
+
+TEST(correctness, rvalue_operators) {
+  big_integer a("-123456789012345678901234567890");
+  big_integer b("98765432109876543210");
+
+  EXPECT_EQ(big_integer("-123456788913580246791358024680"), a + (b + 0));
+  EXPECT_EQ(big_integer("-123456789111111111011111111100"), a - (b + 0));
+  EXPECT_EQ(big_integer("123456789111111111011111111100"), b - (a + 0));
+  EXPECT_EQ(b & a, b & (a + 0));
+  EXPECT_EQ(b | a, b | (a + 0));
+  EXPECT_EQ(b ^ a, b ^ (a + 0));
+  EXPECT_EQ(5 - b, -(b - 5));
+  EXPECT_EQ(0, a - std::move(a));
+}
+
 TEST(correctness, sub) {
   big_integer a = 20;
   big_integer b = 5;
@@ -241,6 +315,25 @@ TEST(correctness, div_rounding_negative) {
   EXPECT_TRUE(c % d == -3);
 }
 
+TEST(correctness, divmod) {
+  big_integer a("-123456789012345678901234567890");
+  big_integer b("98765432109876543210");
+
+  std::pair<big_integer, big_integer> qr = divmod(a, b);
+  EXPECT_EQ(qr.first, a / b);
+  EXPECT_EQ(qr.second, a % b);
+  EXPECT_EQ(a, qr.first * b + qr.second);
+
+  qr = divmod(b, a);
+  EXPECT_EQ(qr.first, 0);
+  EXPECT_EQ(qr.second, b);
+
+  qr = divmod(-b, -b);
+  EXPECT_EQ(qr.first, 1);
+  EXPECT_EQ(qr.second, 0);
+  EXPECT_EQ(to_string(qr.second), "0");
+}
+
 TEST(correctness, div_return_value) {
   big_integer a = 100;
   big_integer b = 2;
@@ -375,6 +468,20 @@ TEST(correctness, xor_return_value) {
   EXPECT_EQ(2, a);
 }
 
+TEST(correctness, bitwise_long_signed) {
+  big_integer a = -(big_integer(1) << 640);
+  big_integer b = -(big_integer(1) << 320);
+  big_integer c = (big_integer(1) << 1000) + 5;
+
+  EXPECT_EQ(a, a & b);
+  EXPECT_EQ(b, a | b);
+  EXPECT_EQ((big_integer(1) << 640) - (big_integer(1) << 320), a ^ b);
+  EXPECT_EQ(big_integer(1) << 1000, a & c);
+  EXPECT_EQ(a + 5, a | c);
+  EXPECT_EQ(-c - 1, ~c);
+  EXPECT_EQ(0, (c ^ a) ^ (a ^ c));
+}
+
 TEST(correctness, not_) {
   big_integer a = 0xaa;
   big_integer b = ~a;
@@ -422,6 +529,19 @@ TEST(correctness, shr_signed) {
   EXPECT_EQ(-155, a);
 }
 
+TEST(correctness, shr_signed_floor) {
+  big_integer a = big_integer(1) << 64;
+
+  EXPECT_EQ(-2, big_integer(-4) >> 1);
+  EXPECT_EQ(-1, big_integer(-1) >> 1);
+  EXPECT_EQ(-1, big_integer(-1) >> 200);
+  EXPECT_EQ(-5, big_integer(-5) >> 0);
+  EXPECT_EQ(-1, -a >> 64);
+  EXPECT_EQ(-2, -(a + 1) >> 64);
+  EXPECT_EQ(-(a >> 3), -a >> 3);
+  EXPECT_EQ(0, big_integer(0) >> 70);
+}
+
 TEST(correctness, shr_return_value) {
   big_integer a = 64;
 
@@ -504,6 +624,180 @@ TEST(correctness, mul_long_pow2) {
   EXPECT_EQ(c, b * b);
 }
 
+TEST(correctness, square) {
+  big_integer a("999999999999999999999999999999999999999912345678901234567890123456789777777777777777777777777777777777777777777777777777777777777");
+  big_integer expected("999999999999999999999999999999999999999824691357802469135780246913579555555555563238835562841030345035817713244566377276939490937386678860049382716049382716049382716049519067215536351165998079561043061728395061728395061728395061728395061728395061728395061729");
+  big_integer b = a;
+
+  EXPECT_EQ(expected, square(a));
+  EXPECT_EQ(expected, square(-a));
+  EXPECT_EQ(expected, a * b);
+  EXPECT_EQ(-expected, -a * b);
+  EXPECT_EQ(0, square(big_integer(0)));
+
+  a *= a;
+  EXPECT_EQ(expected, a);
+  big_integer c = -7;
+  c *= c;
+  EXPECT_EQ(49, c);
+}
+
+TEST(correctness, powmod) {
+  EXPECT_EQ(959082, powmod(3, 200, 1000007));
+  EXPECT_EQ(375, powmod(-12345, 77, 1000));
+  EXPECT_EQ(375, powmod(-12345, 77, -1000));
+  EXPECT_EQ(big_integer("429831652624386837205668069376"),
+            powmod(2, 1000, big_integer("1000000000000000000000000000000")));
+  EXPECT_EQ(1, powmod(5, 0, 7));
+  EXPECT_EQ(0, powmod(5, 0, 1));
+  EXPECT_EQ(1, powmod(5, 0, big_integer("100000000000000000000000")));
+  EXPECT_EQ(1, powmod(5, 0, big_integer("-100000000000000000000000")));
+  EXPECT_EQ(0, powmod(0, 5, 7));
+  EXPECT_THROW(powmod(2, 3, 0), std::invalid_argument);
+  EXPECT_THROW(powmod(2, -3, 7), std::invalid_argument);
+}
+
+TEST(correctness, pow) {
+  EXPECT_EQ(big_integer("515377520732011331036461129765621272702107522001"), pow(big_integer(3), 100));
+  EXPECT_EQ(big_integer("-515377520732011331036461129765621272702107522001"), pow(big_integer(-3), 101) / 3);
+  EXPECT_EQ(big_integer(1) << 1000, pow(big_integer(2), 1000));
+  EXPECT_EQ(-(big_integer(1) << 3003), pow(big_integer(-8), 1001));
+  EXPECT_EQ(pow(big_integer(3), 100) << 6400, pow(big_integer(3) << 64, 100));
+  EXPECT_EQ(pow(big_integer("123456789123456789123456789"), 7),
+            big_integer("123456789123456789123456789") * pow(big_integer("123456789123456789123456789"), 6));
+  EXPECT_EQ(1, pow(big_integer(0), 0));
+  EXPECT_EQ(0, pow(big_integer(0), 5));
+  EXPECT_EQ(-1, pow(big_integer(-1), 7));
+  EXPECT_EQ(1, pow(big_integer(-1), 8));
+  EXPECT_EQ(12345, pow(big_integer(12345), 1));
+  EXPECT_THROW(pow(big_integer(2), -1), std::invalid_argument);
+}
+
+TEST(correctness, product) {
+  EXPECT_EQ(1, product({}));
+  EXPECT_EQ(-7, product({big_integer(-7)}));
+  EXPECT_EQ(-30, product({2, -3, 5}));
+  EXPECT_EQ(0, product({2, 0, big_integer("123456789123456789123456789")}));
+  EXPECT_EQ(big_integer("152415787806736785461057782934003994279682996625361999"),
+            product({big_integer("123456789123456789123456789"), big_integer("1234567891234567891234567891"), 1}));
+}
+
+TEST(correctness, factorial) {
+  EXPECT_EQ(1, factorial(0));
+  EXPECT_EQ(1, factorial(1));
+  EXPECT_EQ(big_integer("2432902008176640000"), factorial(20));
+  EXPECT_EQ(big_integer("51090942171709440000"), factorial(21));
+  EXPECT_EQ(big_integer("30414093201713378043612608166064768844377641568960512000000000000"), factorial(50));
+  EXPECT_THROW(factorial(-1), std::invalid_argument);
+}
+
+TEST(correctness, binomial) {
+  EXPECT_EQ(1, binomial(0, 0));
+  EXPECT_EQ(10, binomial(5, 2));
+  EXPECT_EQ(10, binomial(5, 3));
+  EXPECT_EQ(0, binomial(5, 6));
+  EXPECT_EQ(0, binomial(5, -1));
+  EXPECT_EQ(big_integer("100891344545564193334812497256"), binomial(100, 50));
+  EXPECT_EQ(big_integer("499999500000"), binomial(1000000, 2));
+  EXPECT_EQ(-10, binomial(-3, 3));
+  EXPECT_EQ(15, binomial(-3, 4));
+}
+
+TEST(correctness, modulus) {
+  modulus m(-1000007);
+  EXPECT_EQ(1000007, m.value());
+  EXPECT_EQ(5, m.reduce(1000012));
+  EXPECT_EQ(1000002, m.reduce(-5));
+  EXPECT_EQ(0, m.reduce(-1000007));
+  EXPECT_EQ(3, m.reduce(3));
+  EXPECT_EQ(999965, m.mulmod(2000, 3000));
+  EXPECT_EQ(1, m.addmod(1000000, 8));
+  EXPECT_EQ(1000006, m.addmod(-1, 0));
+  EXPECT_THROW(modulus(0), std::invalid_argument);
+}
+
+TEST(correctness, modulus_power_of_base) {
+  big_integer x = big_integer("1" + std::string(75, '0')) + 7;
+  for (int bits : {64, 128}) {
+    big_integer b = big_integer(1) << bits;
+    modulus m(b);
+    EXPECT_EQ(x % b, m.reduce(x)) << bits;
+    EXPECT_EQ(b - x % b, m.reduce(-x)) << bits;
+    EXPECT_EQ((x * (x + 1)) % b, m.mulmod(x, x + 1)) << bits;
+    EXPECT_EQ(1, m.addmod(b - 1, 2)) << bits;
+  }
+  modulus m(-(big_integer(1) << 64));
+  EXPECT_EQ(x % (big_integer(1) << 64), m.reduce(x));
+  EXPECT_EQ(0, modulus(1).reduce(x));
+}
+
+TEST(correctness, gcd) {
+  EXPECT_EQ(6, gcd(12, 18));
+  EXPECT_EQ(6, gcd(-12, 18));
+  EXPECT_EQ(6, gcd(12, -18));
+  EXPECT_EQ(7, gcd(0, -7));
+  EXPECT_EQ(7, gcd(7, 0));
+  EXPECT_EQ(0, gcd(0, 0));
+  EXPECT_EQ(1, gcd(big_integer("1000000000000000000000000000000000000007"), big_integer("1000000000000000000000000000000")));
+  big_integer p("340282366920938463463374607431768211507");
+  EXPECT_EQ(p, gcd(p * 1000000007, -p * 998244353));
+  EXPECT_EQ(p * 5, gcd(p * p * 10, p * 15));
+}
+
+TEST(correctness, gcdext) {
+  big_integer g, s, t;
+  std::tie(g, s, t) = gcdext(240, 46);
+  EXPECT_EQ(2, g);
+  EXPECT_EQ(-9, s);
+  EXPECT_EQ(47, t);
+  std::tie(g, s, t) = gcdext(-240, 46);
+  EXPECT_EQ(2, g);
+  EXPECT_EQ(9, s);
+  EXPECT_EQ(47, t);
+  std::tie(g, s, t) = gcdext(0, -5);
+  EXPECT_EQ(5, g);
+  EXPECT_EQ(0, s);
+  EXPECT_EQ(-1, t);
+  std::tie(g, s, t) = gcdext(7, 7);
+  EXPECT_EQ(7, g);
+  EXPECT_EQ(0, s);
+  EXPECT_EQ(1, t);
+  big_integer a("340282366920938463463374607431768211507"), b("1000000000000000000000000000000");
+  std::tie(g, s, t) = gcdext(a, b);
+  EXPECT_EQ(1, g);
+  EXPECT_EQ(1, s * a + t * b);
+}
+
+TEST(correctness, invert) {
+  EXPECT_EQ(4, invert(3, 11));
+  EXPECT_EQ(7, invert(-3, 11));
+  EXPECT_EQ(4, invert(3, -11));
+  EXPECT_EQ(0, invert(5, 1));
+  big_integer m("1000000000000000000000000000000000000007");
+  big_integer x = invert(big_integer("123456789123456789123456789"), m);
+  EXPECT_EQ(1, x * big_integer("123456789123456789123456789") % m);
+  EXPECT_THROW(invert(6, 9), std::invalid_argument);
+  EXPECT_THROW(invert(9, 9), std::invalid_argument);
+  EXPECT_THROW(invert(3, 0), std::invalid_argument);
+}
+
+TEST(correctness, iroot) {
+  EXPECT_EQ(0, isqrt(0));
+  EXPECT_EQ(1, isqrt(3));
+  EXPECT_EQ(2, isqrt(4));
+  EXPECT_EQ(big_integer("1000000000000000000000"), isqrt(big_integer("1000000000000000000000000000000000000000000")));
+  EXPECT_EQ(big_integer("999999999999999999999"), isqrt(big_integer("999999999999999999999999999999999999999999")));
+  EXPECT_EQ(4, iroot(124, 3));
+  EXPECT_EQ(5, iroot(125, 3));
+  EXPECT_EQ(-5, iroot(-130, 3));
+  EXPECT_EQ(2, iroot(big_integer("1267650600228229401496703205376"), 100));
+  EXPECT_EQ(1, iroot(big_integer("1267650600228229401496703205375"), 100));
+  EXPECT_EQ(12345, iroot(12345, 1));
+  EXPECT_THROW(isqrt(-1), std::invalid_argument);
+  EXPECT_THROW(iroot(-16, 4), std::invalid_argument);
+  EXPECT_THROW(iroot(16, 0), std::invalid_argument);
+}
+
 TEST(correctness, div_long) {
   big_integer a("10000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000");
   big_integer b("100000000000000000000000000000000000000");
@@ -529,6 +823,14 @@ TEST(correctness, div_long_signed2) {
   EXPECT_EQ(c, a / b);
 }
 
+TEST(correctness, div_long_trial_overflow) {
+  big_integer a(std::string(50, '9'));
+  big_integer b("1000000000000000000");
+
+  EXPECT_EQ(std::string(32, '9'), to_string(a / b));
+  EXPECT_EQ(std::string(18, '9'), to_string(a % b));
+}
+
 TEST(correctness, negation_long) {
   big_integer a("10000000000000000000000000000000000000000000000000000");
   big_integer c("-10000000000000000000000000000000000000000000000000000");
@@ -577,6 +879,32 @@ TEST(correctness, string_conv) {
   EXPECT_EQ("-2147483649", to_string(lim));
 }
 
+TEST(correctness, string_conv_large) {
+  big_integer x = 10;
+  std::string zeros = "0";
+  for (size_t i = 0; i != 15; ++i) {
+    x *= x;
+    zeros += zeros;
+  }
+  EXPECT_EQ("1" + zeros, to_string(x));
+  EXPECT_EQ("-1" + zeros, to_string(-x));
+  EXPECT_EQ(std::string(zeros.size(), '9'), to_string(x - 1));
+  EXPECT_EQ("1" + zeros.substr(1) + "1", to_string(x + 1));
+}
+
+TEST(correctness, string_conv_long_input) {
+  std::string zeros(1000, '0');
+  std::string digits;
+  for (size_t i = 0; i != 1000; ++i)
+    digits += static_cast<char>('0' + i % 10);
+
+  EXPECT_EQ("1234", to_string(big_integer(zeros + "1234")));
+  EXPECT_EQ("-1234", to_string(big_integer("-" + zeros + "1234")));
+  EXPECT_EQ("0", to_string(big_integer("-" + zeros)));
+  EXPECT_EQ(digits.substr(1), to_string(big_integer("+" + digits)));
+  EXPECT_THROW(big_integer(digits + "x"), std::invalid_argument);
+}
+
 namespace {
 size_t const number_of_iterations = 10;
 size_t const max_size = 2048;
@@ -744,6 +1072,424 @@ TEST(correctness_random, mul) {
   }
 }
 
+TEST(correctness_random, mul_karatsuba) {
+  std::default_random_engine rng(42);
+  std::pair<size_t, size_t> const sizes[] = {{4096, 4096}, {8000, 6500}, {30000, 30000}, {30000, 3000}};
+  for (auto const& size : sizes) {
+    big_integer_gmp a, b;
+    a.random(size.first, rng);
+    b.random(size.second, rng);
+    big_integer_gmp c = a * b;
+    big_integer R = big_integer(to_string(a)) * big_integer(to_string(b));
+    EXPECT_EQ(to_string(c), to_string(R));
+  }
+}
+
+TEST(correctness_random, mul_toom) {
+  std::default_random_engine rng(42);
+  std::pair<size_t, size_t> const sizes[] = {{20000, 20000}, {20000, 14000}, {16000, 10000}, {30000, 4000}};
+  for (auto const& size : sizes) {
+    big_integer_gmp a, b;
+    a.random(size.first, rng);
+    b.random(size.second, rng);
+    big_integer_gmp c = a * b;
+    big_integer R = big_integer(to_string(a)) * big_integer(to_string(b));
+    EXPECT_EQ(to_string(c), to_string(R));
+  }
+}
+
+namespace {
+std::vector<limb_t> random_limbs(size_t sz, std::mt19937_64& rng) {
+  std::vector<limb_t> result(sz);
+  for (limb_t& x : result)
+    x = static_cast<limb_t>(rng());
+  return result;
+}
+
+void check_ntt_mul(size_t an, size_t bn, std::mt19937_64& rng) {
+  std::vector<limb_t> a = random_limbs(an, rng), b = random_limbs(bn, rng);
+  std::vector<limb_t> r(an + bn);
+  ntt_mul(r.data(), a.data(), an, b.data(), bn);
+
+  big_integer_gmp x, y;
+  x.import_limbs(a);
+  y.import_limbs(b);
+  EXPECT_TRUE((x * y).export_limbs<limb_t>(an + bn) == r) << an << " x " << bn;
+}
+}
+
+TEST(correctness_random, ntt_mul) {
+  std::mt19937_64 rng(42);
+  for (size_t sz = 1; sz <= (1 << 16); sz *= 2) {
+    check_ntt_mul(sz, sz, rng);
+    check_ntt_mul(sz + 1, sz / 3 + 1, rng);
+  }
+  std::vector<limb_t> ones(1 << 12, LIMB_MAX), r(1 << 13);
+  ntt_mul(r.data(), ones.data(), ones.size(), ones.data(), ones.size());
+  big_integer_gmp x;
+  x.import_limbs(ones);
+  EXPECT_TRUE((x * x).export_limbs<limb_t>(r.size()) == r);
+}
+
+// both threads grow the shared root tables past the sizes above
+TEST(correctness_random, ntt_mul_threads) {
+  std::thread other([] {
+    std::mt19937_64 rng(7);
+    check_ntt_mul(1 << 17, 1 << 17, rng);
+  });
+  std::mt19937_64 rng(42);
+  check_ntt_mul(1 << 18, (1 << 18) - 5, rng);
+  other.join();
+}
+
+TEST(correctness_random, ntt_mul_huge) {
+  std::mt19937_64 rng(42);
+  check_ntt_mul(600000, 520000, rng);
+}
+
+TEST(correctness_random, DISABLED_ntt_mul_max) {
+  std::mt19937_64 rng(42);
+  for (size_t sz = (1 << 19); sz <= (1 << 24); sz *= 2) {
+    check_ntt_mul(sz, sz, rng);
+  }
+}
+
+#if defined(__x86_64__)
+TEST(correctness_random, mul_basecase_adx) {
+  if (!cpu_has_adx())
+    return;
+  std::mt19937_64 rng(42);
+  for (size_t an = 1; an != 40; ++an) {
+    for (size_t bn = 1; bn <= an; bn += 3) {
+      std::vector<limb_t> a = random_limbs(an, rng), b = random_limbs(bn, rng);
+      if (an % 5 == 0) {
+        std::fill(a.begin(), a.end(), LIMB_MAX);
+        std::fill(b.begin(), b.end(), LIMB_MAX);
+      }
+      std::vector<limb_t> expected(an + bn), r(an + bn);
+      mul_basecase_generic(expected.data(), a.data(), an, b.data(), bn);
+      mul_basecase_adx(r.data(), a.data(), an, b.data(), bn);
+      EXPECT_TRUE(r == expected) << an << " x " << bn;
+    }
+  }
+}
+TEST(correctness_random, mul_ifma) {
+  if (!cpu_has_ifma())
+    return;
+  std::mt19937_64 rng(42);
+  std::pair<size_t, size_t> const sizes[] = {{1, 1}, {5, 3}, {13, 13}, {40, 33}, {255, 255}, {700, 90}, {3300, 3300}};
+  for (auto const& size : sizes) {
+    std::vector<limb_t> a = random_limbs(size.first, rng), b = random_limbs(size.second, rng);
+    if (size.first == size.second)
+      std::fill(b.begin(), b.end(), LIMB_MAX);
+    std::vector<limb_t> r(size.first + size.second);
+    mul_ifma(r.data(), a.data(), size.first, b.data(), size.second);
+
+    big_integer_gmp x, y;
+    x.import_limbs(a);
+    y.import_limbs(b);
+    EXPECT_TRUE((x * y).export_limbs<limb_t>(r.size()) == r) << size.first << " x " << size.second;
+  }
+}
+#endif
+
+TEST(correctness_random, sqr) {
+  std::mt19937_64 rng(42);
+  for (size_t n : {1, 2, 17, 47, 130, 300, 700, 2000}) {
+    std::vector<limb_t> a = random_limbs(n, rng);
+    if (n % 2 == 0)
+      std::fill(a.begin(), a.end(), LIMB_MAX);
+    std::vector<limb_t> r(2 * n), s(2 * n), t(2 * n), scratch(karatsuba_scratch_size(n));
+    sqr(r.data(), a.data(), n);
+    sqr_basecase(s.data(), a.data(), n);
+    EXPECT_TRUE(r == s) << n;
+    if (n >= KARATSUBA_THRESHOLD) {
+      karatsuba_sqr(s.data(), a.data(), n, scratch.data());
+      toom3_sqr(t.data(), a.data(), n);
+      EXPECT_TRUE(r == s) << n;
+      EXPECT_TRUE(r == t) << n;
+    }
+
+    big_integer_gmp x;
+    x.import_limbs(a);
+    EXPECT_TRUE((x * x).export_limbs<limb_t>(2 * n) == r) << n;
+  }
+}
+
+// the tiers and loops that CPUs with ADX, IFMA or AVX2 never reach
+TEST(correctness_random, generic_kernels) {
+  std::mt19937_64 rng(42);
+  force_generic_kernels(true);
+#if defined(__x86_64__)
+  EXPECT_FALSE(cpu_has_adx());
+  EXPECT_FALSE(cpu_has_ifma());
+#endif
+  std::pair<size_t, size_t> const sizes[] = {{5, 3}, {31, 31}, {47, 20}, {130, 130}, {230, 230}, {700, 300}};
+  for (auto const& size : sizes) {
+    size_t an = size.first, bn = size.second;
+    std::vector<limb_t> a = random_limbs(an, rng), b = random_limbs(bn, rng);
+    std::vector<limb_t> r(an + bn), s(2 * an), t(an);
+    mul(r.data(), a.data(), an, b.data(), bn);
+    sqr(s.data(), a.data(), an);
+    bitwise_n<bit_xor>(t.data(), a.data(), b.data(), bn, 0, 0, 0);
+
+    big_integer_gmp x, y;
+    x.import_limbs(a);
+    y.import_limbs(b);
+    EXPECT_TRUE((x * y).export_limbs<limb_t>(an + bn) == r) << an << " x " << bn;
+    EXPECT_TRUE((x * x).export_limbs<limb_t>(2 * an) == s) << an;
+    for (size_t i = 0; i < bn; ++i)
+      EXPECT_EQ(a[i] ^ b[i], t[i]) << bn;
+  }
+  force_generic_kernels(false);
+}
+
+#if defined(BIGINT_ASM_KERNELS)
+// the NASM kernels replace the C++ loops, so they are checked against
+// double-limb arithmetic, with empty spans, full carries and in place
+TEST(correctness_random, asm_kernels) {
+  std::mt19937_64 rng(42);
+  for (size_t n : {0, 1, 2, 7, 64}) {
+    for (int ones = 0; ones != 2; ++ones) {
+      std::vector<limb_t> a = random_limbs(n, rng), b = random_limbs(n, rng);
+      limb_t m = rng() | 1;
+      if (ones) {
+        std::fill(a.begin(), a.end(), LIMB_MAX);
+        std::fill(b.begin(), b.end(), LIMB_MAX);
+        m = LIMB_MAX;
+      }
+      std::vector<limb_t> sum(n), diff(n), prod(n), acc(b), dec(b), quo(n);
+      limb_t carry = 0, borrow = 0, mul_carry = 0, add_carry = 0, sub_borrow = 0;
+      for (size_t i = 0; i < n; ++i) {
+        double_limb_t s = static_cast<double_limb_t>(a[i]) + b[i] + carry;
+        sum[i] = static_cast<limb_t>(s);
+        carry = static_cast<limb_t>(s >> LIMB_BITS);
+        double_limb_t d = static_cast<double_limb_t>(a[i]) - b[i] - borrow;
+        diff[i] = static_cast<limb_t>(d);
+        borrow = (d >> LIMB_BITS) != 0;
+        double_limb_t p = static_cast<double_limb_t>(a[i]) * m + mul_carry;
+        prod[i] = static_cast<limb_t>(p);
+        mul_carry = static_cast<limb_t>(p >> LIMB_BITS);
+        p = static_cast<double_limb_t>(a[i]) * m + acc[i] + add_carry;
+        acc[i] = static_cast<limb_t>(p);
+        add_carry = static_cast<limb_t>(p >> LIMB_BITS);
+        p = static_cast<double_limb_t>(a[i]) * m + sub_borrow;
+        sub_borrow = static_cast<limb_t>(p >> LIMB_BITS) + (dec[i] < static_cast<limb_t>(p));
+        dec[i] -= static_cast<limb_t>(p);
+      }
+      double_limb_t rem = 0;
+      for (size_t i = n; i-- != 0;) {
+        rem = (rem << LIMB_BITS) | a[i];
+        quo[i] = static_cast<limb_t>(rem / m);
+        rem %= m;
+      }
+
+      std::vector<limb_t> r(a);
+      EXPECT_EQ(carry, add_n(r.data(), r.data(), b.data(), n)) << n;
+      EXPECT_TRUE(r == sum) << n;
+      r = a;
+      EXPECT_EQ(borrow, sub_n(r.data(), r.data(), b.data(), n)) << n;
+      EXPECT_TRUE(r == diff) << n;
+      r = a;
+      EXPECT_EQ(mul_carry, mul_1(r.data(), r.data(), n, m)) << n;
+      EXPECT_TRUE(r == prod) << n;
+      r = b;
+      EXPECT_EQ(add_carry, addmul_1(r.data(), a.data(), n, m)) << n;
+      EXPECT_TRUE(r == acc) << n;
+      r = b;
+      EXPECT_EQ(sub_borrow, submul_1(r.data(), a.data(), n, m)) << n;
+      EXPECT_TRUE(r == dec) << n;
+      r = a;
+      EXPECT_EQ(static_cast<limb_t>(rem), divrem_1(r.data(), r.data(), n, m)) << n;
+      EXPECT_TRUE(r == quo) << n;
+    }
+  }
+}
+#endif
+
+// called directly, CPUs with IFMA skip Karatsuba in mul
+TEST(correctness_random, karatsuba_mul) {
+  std::mt19937_64 rng(42);
+  for (size_t n : {32, 47, 130, 255, 300, 700, 2000}) {
+    std::vector<limb_t> a = random_limbs(n, rng), b = random_limbs(n, rng);
+    if (n % 2 == 0)
+      std::fill(a.begin(), a.end(), LIMB_MAX);
+    std::vector<limb_t> r(2 * n), scratch(karatsuba_scratch_size(n));
+    karatsuba_mul(r.data(), a.data(), b.data(), n, scratch.data());
+
+    big_integer_gmp x, y;
+    x.import_limbs(a);
+    y.import_limbs(b);
+    EXPECT_TRUE((x * y).export_limbs<limb_t>(2 * n) == r) << n;
+  }
+}
+
+TEST(correctness_random, powmod) {
+  std::default_random_engine rng(42);
+  std::pair<size_t, size_t> const sizes[] = {{64, 64}, {200, 130}, {1000, 500}, {3000, 64}, {4000, 2000}};
+  for (auto const& size : sizes) {
+    for (int odd = 0; odd != 2; ++odd) {
+      big_integer_gmp a, e, m;
+      a.random(2 * size.first, rng);
+      e.random(size.second, rng);
+      m.random(size.first, rng);
+      m *= 2;
+      m += odd;
+      if (e < 0)
+        e = -e;
+      big_integer R = powmod(big_integer(to_string(a)), big_integer(to_string(e)), big_integer(to_string(m)));
+      EXPECT_EQ(to_string(powmod(a, e, m)), to_string(R)) << size.first << " " << odd;
+    }
+  }
+}
+
+TEST(correctness_random, pow) {
+  std::default_random_engine rng(42);
+  std::pair<size_t, int> const sizes[] = {{10, 20000}, {64, 1000}, {1000, 100}, {5000, 31}, {20000, 2}};
+  for (auto const& size : sizes) {
+    for (int shift : {0, 3, 64, 200}) {
+      big_integer_gmp a;
+      a.random(size.first, rng);
+      a *= big_integer_gmp(1) << shift;
+      big_integer_gmp e = pow(a, size.second);
+      EXPECT_EQ(to_string(e), to_string(pow(big_integer(to_string(a)), size.second))) << size.first << " " << shift;
+      EXPECT_EQ(to_string(e * a), to_string(pow(big_integer(to_string(a)), size.second + 1)))
+          << size.first << " " << shift;
+    }
+  }
+}
+
+TEST(correctness_random, product) {
+  std::default_random_engine rng(42);
+  for (size_t size : {10, 64, 1000, 3000}) {
+    std::vector<big_integer> factors;
+    big_integer_gmp expected = 1;
+    for (size_t i = 0; i != 300; ++i) {
+      big_integer_gmp a;
+      a.random(size * (i % 7 + 1), rng);
+      expected *= a;
+      factors.push_back(big_integer(to_string(a)));
+    }
+    EXPECT_EQ(to_string(expected), to_string(product(factors))) << size;
+  }
+}
+
+TEST(correctness_random, factorial) {
+  for (int n : {20, 21, 22, 63, 64, 65, 100, 1000, 12345, 100000, 300001}) {
+    EXPECT_EQ(to_string(big_integer_gmp::factorial(n)), to_string(factorial(n))) << n;
+  }
+}
+
+TEST(correctness_random, binomial) {
+  std::pair<int, int> const cases[] = {{100, 7},        {1000, 500},       {1000, 61},    {1000, 63},
+                                       {12345, 6789},   {100000, 3000},    {100000, 7000}, {300000, 150000},
+                                       {1000000, 2000}, {2000000000, 3}, {-100000, 30000}};
+  for (auto const& c : cases) {
+    EXPECT_EQ(to_string(big_integer_gmp::binomial(c.first, c.second)), to_string(binomial(c.first, c.second)))
+        << c.first << " " << c.second;
+  }
+}
+
+TEST(correctness_random, gcd) {
+  std::default_random_engine rng(42);
+  for (size_t size : {64, 200, 3000, 30000, 200000}) {
+    for (size_t itn = 0; itn != 4; ++itn) {
+      big_integer_gmp a, b, g;
+      a.random(size, rng);
+      b.random(size / (itn + 1), rng);
+      g.random(size / 2, rng);
+      if (itn % 2 == 1) {
+        a *= g;
+        b *= g;
+      }
+      big_integer r = gcd(big_integer(to_string(a)), big_integer(to_string(b)));
+      EXPECT_EQ(to_string(gcd(a, b)), to_string(r)) << size << " " << itn;
+    }
+  }
+}
+
+TEST(correctness_random, gcdext) {
+  std::default_random_engine rng(42);
+  for (size_t size : {64, 200, 3000, 30000, 200000}) {
+    for (size_t itn = 0; itn != 4; ++itn) {
+      big_integer_gmp a, b, g;
+      a.random(size / (itn % 2 + 1), rng);
+      b.random(size / (2 - itn % 2), rng);
+      g.random(size / 2, rng);
+      if (itn >= 2) {
+        a *= g;
+        b *= g;
+      }
+      big_integer_gmp eg, es, et;
+      std::tie(eg, es, et) = gcdext(a, b);
+      big_integer rg, rs, rt;
+      std::tie(rg, rs, rt) = gcdext(big_integer(to_string(a)), big_integer(to_string(b)));
+      EXPECT_EQ(to_string(eg), to_string(rg)) << size << " " << itn;
+      EXPECT_EQ(to_string(es), to_string(rs)) << size << " " << itn;
+      EXPECT_EQ(to_string(et), to_string(rt)) << size << " " << itn;
+
+      if (eg == 1) {
+        EXPECT_EQ(to_string(invert(a, b)), to_string(invert(big_integer(to_string(a)), big_integer(to_string(b)))));
+      }
+    }
+  }
+}
+
+TEST(correctness_random, iroot) {
+  std::default_random_engine rng(42);
+  for (size_t size : {64, 1000, 30000, 300000}) {
+    for (int k : {2, 3, 7, 1000}) {
+      big_integer_gmp a;
+      a.random(size, rng);
+      if (k % 2 == 0 && a < 0)
+        a = -a;
+      EXPECT_EQ(to_string(iroot(a, k)), to_string(iroot(big_integer(to_string(a)), k))) << size << " " << k;
+    }
+    big_integer_gmp a;
+    a.random(size, rng);
+    if (a < 0)
+      a = -a;
+    big_integer_gmp square = a * a;
+    EXPECT_EQ(to_string(a), to_string(isqrt(big_integer(to_string(square))))) << size;
+    EXPECT_EQ(to_string(isqrt(square - 1)), to_string(isqrt(big_integer(to_string(square - 1))))) << size;
+  }
+}
+
+TEST(correctness_random, modulus) {
+  std::default_random_engine rng(42);
+  for (size_t size : {64, 500, 3000, 20000}) {
+    big_integer_gmp m;
+    m.random(size, rng);
+    modulus ctx(big_integer(to_string(m)));
+    if (m < 0)
+      m = -m;
+    for (size_t itn = 0; itn != 10; ++itn) {
+      big_integer_gmp a, b;
+      a.random(size * (itn % 4 + 1), rng);
+      b.random(size, rng);
+      big_integer_gmp expected = a % m;
+      if (expected < 0)
+        expected += m;
+      EXPECT_EQ(to_string(expected), to_string(ctx.reduce(big_integer(to_string(a))))) << size;
+
+      big_integer x = ctx.reduce(big_integer(to_string(b)));
+      big_integer y = ctx.reduce(big_integer(to_string(a)));
+      big_integer_gmp gx(to_string(x)), gy(to_string(y));
+      EXPECT_EQ(to_string(gx * gy % m), to_string(ctx.mulmod(x, y))) << size;
+      EXPECT_EQ(to_string((gx + gy) % m), to_string(ctx.addmod(x, y))) << size;
+    }
+  }
+}
+
+TEST(correctness_random, string_conv) {
+  std::default_random_engine rng(42);
+  for (size_t sz = 1000; sz <= 100000; sz *= 10) {
+    big_integer_gmp a;
+    a.random(sz, rng);
+    EXPECT_EQ(to_string(a), to_string(big_integer(to_string(a))));
+  }
+}
+
 TEST(correctness_random, div) {
   std::default_random_engine rng(322);
   for (size_t itn = 0; itn != number_of_iterations; ++itn) {
@@ -760,6 +1506,43 @@ TEST(correctness_random, div) {
   }
 }
 
+TEST(correctness_random, divrem_recursive) {
+  std::mt19937_64 rng(42);
+  std::pair<size_t, size_t> sizes[] = {{200, 100}, {1000, 300}, {1001, 999}, {5000, 1700}, {4000, 61}};
+  for (auto size : sizes) {
+    size_t an = size.first, bn = size.second;
+    std::vector<limb_t> a = random_limbs(an, rng), b = random_limbs(bn, rng);
+    b.back() >>= bn % 17;
+    std::vector<limb_t> q(an - bn + 1), r(bn);
+    divrem(q.data(), r.data(), a.data(), an, b.data(), bn);
+
+    big_integer_gmp x, y;
+    x.import_limbs(a);
+    y.import_limbs(b);
+    EXPECT_TRUE((x / y).export_limbs<limb_t>(q.size()) == q) << an << " / " << bn;
+    EXPECT_TRUE((x % y).export_limbs<limb_t>(r.size()) == r) << an << " / " << bn;
+  }
+}
+
+TEST(correctness_random, divrem_reciprocal) {
+  std::mt19937_64 rng(42);
+  size_t bn = 20000;
+  std::vector<limb_t> b = random_limbs(bn, rng);
+  reciprocal inv(b.data(), bn);
+  big_integer_gmp y;
+  y.import_limbs(b);
+  for (size_t an : {bn, bn + 7, 3 * bn + 1}) {
+    std::vector<limb_t> a = random_limbs(an, rng);
+    std::vector<limb_t> q(an - bn + 1), r(bn);
+    inv.divrem(q.data(), r.data(), a.data(), an);
+
+    big_integer_gmp x;
+    x.import_limbs(a);
+    EXPECT_TRUE((x / y).export_limbs<limb_t>(q.size()) == q) << an;
+    EXPECT_TRUE((x % y).export_limbs<limb_t>(r.size()) == r) << an;
+  }
+}
+
 TEST(correctness_random, mod) {
   std::default_random_engine rng(322);
   for (size_t itn = 0; itn != number_of_iterations; ++itn) {
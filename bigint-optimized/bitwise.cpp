@@ -0,0 +1,64 @@
+#include "limb_arithmetic.h"
+
+#include <cstring>
+#include <type_traits>
+
+namespace {
+typedef limb_t limb_block __attribute__((vector_size(32)));
+constexpr size_t BLOCK_LIMBS = sizeof(limb_block) / sizeof(limb_t);
+
+// the block type maps to one AVX2 register, or to a pair of SSE2 ones
+// when the function is compiled for the baseline; the operation is
+// spelled out rather than passed to Op, which would take vectors by value
+template <typename Op>
+inline size_t bitwise_blocks(limb_t *r, limb_t const *a, limb_t const *b, size_t n,
+                             limb_t ma, limb_t mb, limb_t mr)
+{
+    limb_block va = {ma, ma, ma, ma}, vb = {mb, mb, mb, mb}, vr = {mr, mr, mr, mr};
+    size_t i = 0;
+    for (; i + BLOCK_LIMBS <= n; i += BLOCK_LIMBS) {
+        limb_block x, y;
+        std::memcpy(&x, a + i, sizeof(x));
+        std::memcpy(&y, b + i, sizeof(y));
+        x ^= va;
+        y ^= vb;
+        limb_block z = (std::is_same<Op, bit_and>::value ? x & y : std::is_same<Op, bit_or>::value ? x | y : x ^ y);
+        z ^= vr;
+        std::memcpy(r + i, &z, sizeof(z));
+    }
+    return i;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+template <typename Op>
+__attribute__((target("avx2"))) size_t bitwise_blocks_avx2(limb_t *r, limb_t const *a, limb_t const *b, size_t n,
+                                                          limb_t ma, limb_t mb, limb_t mr)
+{
+    return bitwise_blocks<Op>(r, a, b, n, ma, mb, mr);
+}
+
+bool const HAS_AVX2 = __builtin_cpu_supports("avx2");
+#endif
+}
+
+template <typename Op>
+void bitwise_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n, limb_t ma, limb_t mb, limb_t mr)
+{
+    size_t i;
+#if defined(__x86_64__) || defined(__i386__)
+    if (HAS_AVX2 && !generic_kernels_forced()) {
+        i = bitwise_blocks_avx2<Op>(r, a, b, n, ma, mb, mr);
+    } else {
+        i = bitwise_blocks<Op>(r, a, b, n, ma, mb, mr);
+    }
+#else
+    i = bitwise_blocks<Op>(r, a, b, n, ma, mb, mr);
+#endif
+    for (; i < n; i++) {
+        r[i] = Op()(a[i] ^ ma, b[i] ^ mb) ^ mr;
+    }
+}
+
+template void bitwise_n<bit_and>(limb_t *, limb_t const *, limb_t const *, size_t, limb_t, limb_t, limb_t);
+template void bitwise_n<bit_or>(limb_t *, limb_t const *, limb_t const *, size_t, limb_t, limb_t, limb_t);
+template void bitwise_n<bit_xor>(limb_t *, limb_t const *, limb_t const *, size_t, limb_t, limb_t, limb_t);
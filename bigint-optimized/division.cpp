@@ -0,0 +1,272 @@
+#include "limb_arithmetic.h"
+
+#include <algorithm>
+#include <vector>
+
+// Knuth's algorithm D with a normalized divisor: every quotient limb is
+// estimated from the top three limbs of the window, which leaves at most
+// one add-back after the multiply-subtract
+limb_t divrem_basecase(limb_t *q, limb_t *np, size_t nn, limb_t const *d, size_t dn)
+{
+    limb_t qh = (compare_n(np + nn - dn, d, dn) >= 0 ? 1 : 0);
+    if (qh != 0) {
+        sub_n(np + nn - dn, np + nn - dn, d, dn);
+    }
+    if (dn == 1) {
+        double_limb_t rem = np[nn - 1];
+        for (size_t i = nn - 1; i != 0; i--) {
+            double_limb_t cur = (rem << LIMB_BITS) | np[i - 1];
+            q[i - 1] = static_cast<limb_t>(cur / d[0]);
+            rem = cur % d[0];
+        }
+        np[0] = static_cast<limb_t>(rem);
+        return qh;
+    }
+    limb_t d1 = d[dn - 1], d0 = d[dn - 2];
+    for (size_t j = nn - dn; j != 0; j--) {
+        limb_t *window = np + j - 1;
+        limb_t n2 = window[dn], n1 = window[dn - 1], n0 = window[dn - 2];
+        limb_t qhat, rhat;
+        bool overflow = false;
+        if (n2 >= d1) {
+            qhat = LIMB_MAX;
+            rhat = n1 + d1;
+            overflow = rhat < n1;
+        } else {
+            double_limb_t top = (static_cast<double_limb_t>(n2) << LIMB_BITS) | n1;
+            qhat = static_cast<limb_t>(top / d1);
+            rhat = static_cast<limb_t>(top % d1);
+        }
+        while (!overflow &&
+               static_cast<double_limb_t>(qhat) * d0 > ((static_cast<double_limb_t>(rhat) << LIMB_BITS) | n0)) {
+            qhat--;
+            rhat += d1;
+            overflow = rhat < d1;
+        }
+        limb_t borrow = submul_1(window, d, dn, qhat);
+        window[dn] = n2 - borrow;
+        if (n2 < borrow) {
+            qhat--;
+            window[dn] += add_n(window, window, d, dn);
+        }
+        q[j - 1] = qhat;
+    }
+    return qh;
+}
+
+namespace {
+// {np, 2n} / {d, n}: the top half of the quotient comes from dividing by
+// the top half of d and is then corrected by the low product Q1 * D0,
+// the bottom half is obtained the same way from the remainder
+limb_t divrem_2n_1n(limb_t *q, limb_t *np, limb_t const *d, size_t n, limb_t *tmp)
+{
+    size_t lo = n / 2, hi = n - lo;
+    limb_t qh;
+    if (hi < DIV_BZ_THRESHOLD) {
+        qh = divrem_basecase(q + lo, np + 2 * lo, 2 * hi, d + lo, hi);
+    } else {
+        qh = divrem_2n_1n(q + lo, np + 2 * lo, d + lo, hi, tmp);
+    }
+    mul(tmp, q + lo, hi, d, lo);
+    limb_t borrow = sub_n(np + lo, np + lo, tmp, n);
+    if (qh != 0) {
+        borrow += sub_n(np + n, np + n, d, lo);
+    }
+    while (borrow != 0) {
+        qh -= sub_1(q + lo, q + lo, hi, 1);
+        borrow -= add_n(np + lo, np + lo, d, n);
+    }
+
+    limb_t ql;
+    if (lo < DIV_BZ_THRESHOLD) {
+        ql = divrem_basecase(q, np + hi, 2 * lo, d + hi, lo);
+    } else {
+        ql = divrem_2n_1n(q, np + hi, d + hi, lo, tmp);
+    }
+    mul(tmp, d, hi, q, lo);
+    borrow = sub_n(np, np, tmp, n);
+    if (ql != 0) {
+        borrow += sub_n(np + lo, np + lo, d, hi);
+    }
+    while (borrow != 0) {
+        sub_1(q, q, lo, 1);
+        borrow -= add_n(np, np, d, n);
+    }
+    return qh;
+}
+
+// divides the top 2 qn limbs by the top qn limbs of d and fixes the
+// estimate with the ignored low dn - qn limbs of the divisor
+limb_t divrem_top_block(limb_t *q, limb_t *np, size_t qn, limb_t const *d, size_t dn, limb_t *tmp)
+{
+    limb_t qh;
+    limb_t *block = np + dn - qn;
+    if (qn < DIV_BZ_THRESHOLD) {
+        qh = divrem_basecase(q, block, 2 * qn, d + dn - qn, qn);
+    } else {
+        qh = divrem_2n_1n(q, block, d + dn - qn, qn, tmp);
+    }
+    if (qn != dn) {
+        if (qn > dn - qn) {
+            mul(tmp, q, qn, d, dn - qn);
+        } else {
+            mul(tmp, d, dn - qn, q, qn);
+        }
+        limb_t borrow = sub_n(np, np, tmp, dn);
+        if (qh != 0) {
+            borrow += sub_n(np + qn, np + qn, d, dn - qn);
+        }
+        while (borrow != 0) {
+            qh -= sub_1(q, q, qn, 1);
+            borrow -= add_n(np, np, d, dn);
+        }
+    }
+    return qh;
+}
+
+// quotient limbs are produced in blocks of dn from the top, the first
+// block takes the remaining qn mod dn limbs
+limb_t divrem_recursive(limb_t *q, limb_t *np, size_t nn, limb_t const *d, size_t dn, limb_t *tmp)
+{
+    size_t qn = nn - dn;
+    if (qn == 0) {
+        limb_t qh = (compare_n(np, d, dn) >= 0 ? 1 : 0);
+        if (qh != 0) {
+            sub_n(np, np, d, dn);
+        }
+        return qh;
+    }
+    size_t first = qn % dn;
+    if (first == 0) {
+        first = dn;
+    }
+    size_t pos = qn - first;
+    limb_t qh = divrem_top_block(q + pos, np + pos, first, d, dn, tmp);
+    while (pos != 0) {
+        pos -= dn;
+        divrem_2n_1n(q + pos, np + pos, d, dn, tmp);
+    }
+    return qh;
+}
+
+// v[0, n + 1) approximates (B^2n - 1) / d for a normalized d from below,
+// off by less than INVERT_SLACK + 4. The reciprocal of the top h limbs
+// is lifted by one Newton step x + x (B^2n - d x) / B^2n; the extra guard
+// limb in h keeps the error of every level from growing
+constexpr limb_t INVERT_SLACK = 5;
+
+void invert(limb_t *v, limb_t const *d, size_t n)
+{
+    if (n < DIV_NEWTON_THRESHOLD) {
+        std::vector<limb_t> ones(2 * n, LIMB_MAX), r(n);
+        divrem(v, r.data(), ones.data(), 2 * n, d, n);
+        return;
+    }
+    size_t h = (n + 1) / 2 + 1, l = n - h;
+    std::vector<limb_t> vh(h + 1);
+    invert(vh.data(), d + l, h);
+
+    // e = |B^(n+h) - d vh| / B^h, which fits in l + 1 limbs
+    std::vector<limb_t> p(n + h + 1);
+    mul(p.data(), d, n, vh.data(), h + 1);
+    bool negative = (p[n + h] != 0);
+    if (negative) {
+        p[n + h]--;
+    } else {
+        for (size_t i = 0; i < n + h; i++) {
+            p[i] = ~p[i];
+        }
+        add_1(p.data(), p.data(), n + h, 1);
+    }
+    limb_t const *e = p.data() + h;
+
+    std::vector<limb_t> c(h + l + 2);
+    mul(c.data(), vh.data(), h + 1, e, l + 1);
+    std::fill(v, v + l, 0);
+    std::copy(vh.begin(), vh.end(), v + l);
+    if (negative) {
+        sub(v, v, n + 1, c.data() + h, l + 2);
+    } else {
+        add(v, v, n + 1, c.data() + h, l + 2);
+    }
+    sub_1(v, v, n + 1, INVERT_SLACK);
+}
+}
+
+reciprocal::reciprocal(limb_t const *b, size_t bn) : divisor(bn), inverse(bn + 1)
+{
+    shift = static_cast<unsigned>(__builtin_clzll(b[bn - 1]));
+    if (shift != 0) {
+        lshift(divisor.data(), b, bn, shift);
+    } else {
+        std::copy(b, b + bn, divisor.begin());
+    }
+    invert(inverse.data(), divisor.data(), bn);
+}
+
+size_t reciprocal::size() const
+{
+    return divisor.size();
+}
+
+// quotient blocks of up to n limbs are estimated from the top limbs of
+// the partial remainder times the reciprocal, which undershoots by a
+// small bounded amount that is fixed by subtracting d again
+void reciprocal::divrem(limb_t *q, limb_t *r, limb_t const *a, size_t an) const
+{
+    size_t n = divisor.size();
+    limb_t const *d = divisor.data();
+    std::vector<limb_t> np(an + 1), prod(2 * n + 1);
+    if (shift != 0) {
+        np[an] = lshift(np.data(), a, an, shift);
+    } else {
+        std::copy(a, a + an, np.begin());
+    }
+    for (size_t pos = an + 1 - n; pos != 0;) {
+        size_t k = std::min(n, pos);
+        pos -= k;
+        limb_t *window = np.data() + pos;
+        mul(prod.data(), inverse.data(), n + 1, window + n, k);
+        std::copy(prod.begin() + n, prod.begin() + n + k, q + pos);
+        mul(prod.data(), d, n, q + pos, k);
+        sub_n(window, window, prod.data(), n + k);
+        while (window[n] != 0 || compare_n(window, d, n) >= 0) {
+            add_1(q + pos, q + pos, k, 1);
+            sub(window, window, n + k, d, n);
+        }
+    }
+    if (shift != 0) {
+        rshift(r, np.data(), n, shift);
+    } else {
+        std::copy(np.begin(), np.begin() + n, r);
+    }
+}
+
+void divrem(limb_t *q, limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn)
+{
+    // computing the reciprocal costs a few multiplications, which pays off
+    // once it serves several quotient blocks or the divisor is huge
+    if (bn >= DIV_NEWTON_THRESHOLD && (an >= 4 * bn || bn >= 32 * DIV_NEWTON_THRESHOLD)) {
+        reciprocal(b, bn).divrem(q, r, a, an);
+        return;
+    }
+    unsigned shift = static_cast<unsigned>(__builtin_clzll(b[bn - 1]));
+    std::vector<limb_t> np(an + 1), dp(b, b + bn);
+    if (shift != 0) {
+        np[an] = lshift(np.data(), a, an, shift);
+        lshift(dp.data(), b, bn, shift);
+    } else {
+        std::copy(a, a + an, np.begin());
+    }
+    if (bn < DIV_BZ_THRESHOLD || an - bn < DIV_BZ_THRESHOLD) {
+        divrem_basecase(q, np.data(), an + 1, dp.data(), bn);
+    } else {
+        std::vector<limb_t> tmp(bn);
+        divrem_recursive(q, np.data(), an + 1, dp.data(), bn, tmp.data());
+    }
+    if (shift != 0) {
+        rshift(r, np.data(), bn, shift);
+    } else {
+        std::copy(np.begin(), np.begin() + bn, r);
+    }
+}
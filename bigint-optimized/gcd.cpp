@@ -0,0 +1,610 @@
+#include "limb_arithmetic.h"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace {
+// t = x y where either factor may be zero, returns the size of t
+size_t product(std::vector<limb_t> &t, limb_t const *x, size_t xn, limb_t const *y, size_t yn)
+{
+    xn = normalized_size(x, xn);
+    yn = normalized_size(y, yn);
+    if (xn == 0 || yn == 0) {
+        return 0;
+    }
+    t.resize(xn + yn);
+    if (xn >= yn) {
+        mul(t.data(), x, xn, y, yn);
+    } else {
+        mul(t.data(), y, yn, x, xn);
+    }
+    return normalized_size(t.data(), xn + yn);
+}
+
+// r[0, rn) += x y
+void add_product(limb_t *r, size_t rn, limb_t const *x, size_t xn, limb_t const *y, size_t yn)
+{
+    std::vector<limb_t> t;
+    add(r, r, rn, t.data(), product(t, x, xn, y, yn));
+}
+
+// r[0, rn) -= x y
+void sub_product(limb_t *r, size_t rn, limb_t const *x, size_t xn, limb_t const *y, size_t yn)
+{
+    std::vector<limb_t> t;
+    sub(r, r, rn, t.data(), product(t, x, xn, y, yn));
+}
+
+// Reduction matrices have non-negative entries and determinant 1 and
+// relate the inputs to the current pair as (a; b) = M (alpha; beta), so
+// alpha = u11 a - u01 b and beta = u00 b - u10 a. Subtracting q times
+// beta from alpha adds q times the first column to the second one.
+struct matrix1
+{
+    limb_t u[2][2];
+};
+
+struct hgcd_matrix
+{
+    hgcd_matrix() : n(1)
+    {
+        for (size_t i = 0; i < 2; i++) {
+            for (size_t j = 0; j < 2; j++) {
+                u[i][j].assign(1, (i == j ? 1 : 0));
+            }
+        }
+    }
+
+    void resize(size_t size)
+    {
+        n = size;
+        for (size_t i = 0; i < 2; i++) {
+            for (size_t j = 0; j < 2; j++) {
+                u[i][j].resize(n);
+            }
+        }
+    }
+
+    void normalize()
+    {
+        size_t size = n;
+        while (size > 1 && (u[0][0][size - 1] | u[0][1][size - 1] | u[1][0][size - 1] | u[1][1][size - 1]) == 0) {
+            size--;
+        }
+        resize(size);
+    }
+
+    // column col += q * column (1 - col)
+    void update_q(limb_t const *q, size_t qn, size_t col)
+    {
+        resize(n + qn + 1);
+        for (size_t row = 0; row < 2; row++) {
+            add_product(u[row][col].data(), n, q, qn, u[row][1 - col].data(), n - qn - 1);
+        }
+        normalize();
+    }
+
+    // M = M M1
+    void mul(matrix1 const &m)
+    {
+        size_t size = n;
+        resize(n + 1);
+        scratch.resize(2 * size);
+        limb_t *x = scratch.data(), *y = x + size;
+        for (size_t row = 0; row < 2; row++) {
+            std::copy(u[row][0].begin(), u[row][0].begin() + size, x);
+            std::copy(u[row][1].begin(), u[row][1].begin() + size, y);
+            for (size_t col = 0; col < 2; col++) {
+                limb_t *r = u[row][col].data();
+                r[size] = mul_1(r, x, size, m.u[0][col]);
+                r[size] += addmul_1(r, y, size, m.u[1][col]);
+            }
+        }
+        normalize();
+    }
+
+    // M = M M1
+    void mul(hgcd_matrix const &m)
+    {
+        size_t size = n + m.n + 1;
+        hgcd_matrix product;
+        product.resize(size);
+        for (size_t row = 0; row < 2; row++) {
+            for (size_t col = 0; col < 2; col++) {
+                limb_t *r = product.u[row][col].data();
+                std::fill(r, r + size, 0);
+                add_product(r, size, u[row][0].data(), n, m.u[0][col].data(), m.n);
+                add_product(r, size, u[row][1].data(), n, m.u[1][col].data(), m.n);
+            }
+        }
+        *this = std::move(product);
+        normalize();
+    }
+
+    std::vector<limb_t> u[2][2];
+    size_t n;
+
+private:
+    std::vector<limb_t> scratch;
+};
+
+// Lehmer step on the top two limbs of a and b: collects the quotients of
+// Euclid's algorithm on them as long as they are guaranteed to be the
+// quotients of the full numbers as well, which holds while the smaller
+// value and the difference stay above a limb and a half. Returns false
+// when not even one step could be taken.
+bool hgcd2(limb_t ah, limb_t al, limb_t bh, limb_t bl, matrix1 &m)
+{
+    constexpr unsigned HALF = LIMB_BITS / 2;
+    double_limb_t a = (static_cast<double_limb_t>(ah) << LIMB_BITS) | al;
+    double_limb_t b = (static_cast<double_limb_t>(bh) << LIMB_BITS) | bl;
+    double_limb_t const two = static_cast<double_limb_t>(2) << LIMB_BITS;
+    limb_t u00, u01, u10, u11;
+    if (ah < 2 || bh < 2) {
+        return false;
+    }
+    bool reduce_a = (a > b);
+    if (reduce_a) {
+        a -= b;
+        if (a < two) {
+            return false;
+        }
+        u00 = u01 = u11 = 1;
+        u10 = 0;
+    } else {
+        b -= a;
+        if (b < two) {
+            return false;
+        }
+        u00 = u10 = u11 = 1;
+        u01 = 0;
+    }
+
+    // double limb precision while the values keep more than one and a
+    // half limbs, the quotient is one too large when the remainder is
+    // not big enough to continue
+    bool single = false;
+    reduce_a = (a > b);
+    for (;;) {
+        if (a == b) {
+            break;
+        }
+        if (reduce_a) {
+            if ((a >> LIMB_BITS) < (static_cast<limb_t>(1) << HALF)) {
+                single = true;
+                break;
+            }
+            a -= b;
+            if (a < two) {
+                break;
+            }
+            if (a <= b) {
+                u01 += u00;
+                u11 += u10;
+            } else {
+                limb_t q = static_cast<limb_t>(a / b);
+                a %= b;
+                if (a < two) {
+                    u01 += q * u00;
+                    u11 += q * u10;
+                    break;
+                }
+                q++;
+                u01 += q * u00;
+                u11 += q * u10;
+            }
+        } else {
+            if ((b >> LIMB_BITS) < (static_cast<limb_t>(1) << HALF)) {
+                single = true;
+                break;
+            }
+            b -= a;
+            if (b < two) {
+                break;
+            }
+            if (b <= a) {
+                u00 += u01;
+                u10 += u11;
+            } else {
+                limb_t q = static_cast<limb_t>(b / a);
+                b %= a;
+                if (b < two) {
+                    u00 += q * u01;
+                    u10 += q * u11;
+                    break;
+                }
+                q++;
+                u00 += q * u01;
+                u10 += q * u11;
+            }
+        }
+        reduce_a = !reduce_a;
+    }
+
+    // the same on the top limb and a half, down to half a limb
+    if (single) {
+        limb_t x = static_cast<limb_t>(a >> HALF), y = static_cast<limb_t>(b >> HALF);
+        limb_t const limit = static_cast<limb_t>(1) << (HALF + 1);
+        for (;;) {
+            if (reduce_a) {
+                x -= y;
+                if (x < limit) {
+                    break;
+                }
+                if (x <= y) {
+                    u01 += u00;
+                    u11 += u10;
+                } else {
+                    limb_t q = x / y;
+                    x %= y;
+                    if (x < limit) {
+                        u01 += q * u00;
+                        u11 += q * u10;
+                        break;
+                    }
+                    q++;
+                    u01 += q * u00;
+                    u11 += q * u10;
+                }
+            } else {
+                y -= x;
+                if (y < limit) {
+                    break;
+                }
+                if (y <= x) {
+                    u00 += u01;
+                    u10 += u11;
+                } else {
+                    limb_t q = y / x;
+                    y %= x;
+                    if (y < limit) {
+                        u00 += q * u01;
+                        u10 += q * u11;
+                        break;
+                    }
+                    q++;
+                    u00 += q * u01;
+                    u10 += q * u11;
+                }
+            }
+            reduce_a = !reduce_a;
+        }
+    }
+    m.u[0][0] = u00;
+    m.u[0][1] = u01;
+    m.u[1][0] = u10;
+    m.u[1][1] = u11;
+    return true;
+}
+
+// (a; b) = M1^-1 (a; b) with scratch for 2n limbs, returns the size of
+// the larger result; both results are non-negative and no larger than
+// the inputs, the asserts only check that in debug builds
+size_t apply_inverse(matrix1 const &m, limb_t *a, limb_t *b, size_t n, limb_t *scratch)
+{
+    limb_t *x = scratch, *y = scratch + n;
+    limb_t high = mul_1(x, a, n, m.u[1][1]);
+    high -= submul_1(x, b, n, m.u[0][1]);
+    assert(high == 0);
+    high = mul_1(y, b, n, m.u[0][0]);
+    high -= submul_1(y, a, n, m.u[1][0]);
+    assert(high == 0);
+    std::copy(x, x + n, a);
+    std::copy(y, y + n, b);
+    while (n != 0 && a[n - 1] == 0 && b[n - 1] == 0) {
+        n--;
+    }
+    return n;
+}
+
+// a and b hold alpha and beta = M^-1 of their top parts from limb p on
+// and the original low parts below, turns them into M^-1 (a; b)
+size_t adjust(hgcd_matrix const &m, size_t n, limb_t *a, limb_t *b, size_t p)
+{
+    size_t len = std::max(n, p + m.n) + 1;
+    std::vector<limb_t> a0(a, a + p), b0(b, b + p), x(len), y(len);
+    std::copy(a + p, a + n, x.begin() + p);
+    std::copy(b + p, b + n, y.begin() + p);
+    add_product(x.data(), len, m.u[1][1].data(), m.n, a0.data(), p);
+    sub_product(x.data(), len, m.u[0][1].data(), m.n, b0.data(), p);
+    add_product(y.data(), len, m.u[0][0].data(), m.n, b0.data(), p);
+    sub_product(y.data(), len, m.u[1][0].data(), m.n, a0.data(), p);
+    size_t size = std::max(normalized_size(x.data(), len), normalized_size(y.data(), len));
+    // M^-1 never grows the pair, checked in debug builds only
+    assert(size <= n);
+    std::copy(x.begin(), x.begin() + n, a);
+    std::copy(y.begin(), y.begin() + n, b);
+    return size;
+}
+
+// one subtraction and one division on the full numbers, for when the top
+// limbs do not determine the quotient; refuses to bring the smaller value
+// down to s limbs or less and returns 0 then, as well as for equal values
+size_t subdiv_step(limb_t *a, limb_t *b, size_t n, size_t s, hgcd_matrix *m)
+{
+    limb_t *p[2] = {a, b};
+    size_t size[2] = {normalized_size(a, n), normalized_size(b, n)};
+    auto larger = [&]() -> int {
+        if (size[0] != size[1]) {
+            return (size[0] > size[1] ? 0 : 1);
+        }
+        int c = compare_n(p[0], p[1], size[0]);
+        return (c == 0 ? -1 : c > 0 ? 0 : 1);
+    };
+
+    int big = larger();
+    if (big < 0 || size[1 - big] <= s) {
+        return 0;
+    }
+    limb_t *x = p[big], *y = p[1 - big];
+    sub(x, x, size[big], y, size[1 - big]);
+    size_t xn = normalized_size(x, size[big]);
+    if (xn <= s) {
+        if (add(x, y, size[1 - big], x, xn) != 0) {
+            x[size[1 - big]] = 1;
+        }
+        return 0;
+    }
+    size[big] = xn;
+    if (m != nullptr) {
+        limb_t one = 1;
+        m->update_q(&one, 1, 1 - big);
+    }
+
+    big = larger();
+    if (big < 0) {
+        return xn;
+    }
+    x = p[big];
+    y = p[1 - big];
+    size_t yn = size[1 - big];
+    size_t qn = size[big] - yn + 1;
+    std::vector<limb_t> q(qn), r(yn);
+    divrem(q.data(), r.data(), x, size[big], y, yn);
+    std::fill(x, x + size[big], 0);
+    size_t rn = normalized_size(r.data(), yn);
+    if (rn <= s) {
+        // keep the remainder above s limbs with one step less
+        if (add(x, y, yn, r.data(), rn) != 0) {
+            x[yn] = 1;
+        }
+        sub_1(q.data(), q.data(), qn, 1);
+    } else {
+        std::copy(r.begin(), r.begin() + rn, x);
+    }
+    qn = normalized_size(q.data(), qn);
+    if (m != nullptr && qn != 0) {
+        m->update_q(q.data(), qn, 1 - big);
+    }
+    return std::max(yn, normalized_size(x, std::min(yn + 1, n)));
+}
+
+// the top two limbs of a and b, shifted together so that the larger one
+// is normalized
+void top_limbs(limb_t const *a, limb_t const *b, size_t n, limb_t *ah, limb_t *al, limb_t *bh, limb_t *bl)
+{
+    limb_t mask = a[n - 1] | b[n - 1];
+    unsigned shift = 0;
+    while ((mask << shift) >> (LIMB_BITS - 1) == 0) {
+        shift++;
+    }
+    if (shift == 0) {
+        *ah = a[n - 1];
+        *al = a[n - 2];
+        *bh = b[n - 1];
+        *bl = b[n - 2];
+    } else {
+        limb_t a3 = (n > 2 ? a[n - 3] : 0), b3 = (n > 2 ? b[n - 3] : 0);
+        *ah = (a[n - 1] << shift) | (a[n - 2] >> (LIMB_BITS - shift));
+        *al = (a[n - 2] << shift) | (a3 >> (LIMB_BITS - shift));
+        *bh = (b[n - 1] << shift) | (b[n - 2] >> (LIMB_BITS - shift));
+        *bl = (b[n - 2] << shift) | (b3 >> (LIMB_BITS - shift));
+    }
+}
+
+size_t hgcd_step(size_t n, limb_t *a, limb_t *b, size_t s, hgcd_matrix &m)
+{
+    limb_t ah, al, bh, bl;
+    if (n == s + 1) {
+        // unshifted, the reduction must not go below s limbs
+        if ((a[n - 1] | b[n - 1]) < 4) {
+            return subdiv_step(a, b, n, s, &m);
+        }
+        ah = a[n - 1];
+        al = a[n - 2];
+        bh = b[n - 1];
+        bl = b[n - 2];
+    } else {
+        top_limbs(a, b, n, &ah, &al, &bh, &bl);
+    }
+    matrix1 m1;
+    if (hgcd2(ah, al, bh, bl, m1)) {
+        m.mul(m1);
+        std::vector<limb_t> scratch(2 * n);
+        return apply_inverse(m1, a, b, n, scratch.data());
+    }
+    return subdiv_step(a, b, n, s, &m);
+}
+
+// Reduces a and b of n limbs by the first steps of Euclid's algorithm
+// for as long as both stay above s = n / 2 + 1 limbs, M collects the
+// steps. Above HGCD_THRESHOLD the top halves are reduced recursively and
+// the matrices applied to the whole numbers. Returns the new size, or 0
+// if no step could be taken.
+size_t hgcd(limb_t *a, limb_t *b, size_t n, hgcd_matrix &m)
+{
+    size_t s = n / 2 + 1;
+    if (n <= s) {
+        return 0;
+    }
+    bool success = false;
+    if (n >= HGCD_THRESHOLD) {
+        size_t n2 = (3 * n) / 4 + 1;
+        size_t p = n / 2;
+        size_t nn = hgcd(a + p, b + p, n - p, m);
+        if (nn != 0) {
+            n = adjust(m, p + nn, a, b, p);
+            success = true;
+        }
+        while (n > n2) {
+            nn = hgcd_step(n, a, b, s, m);
+            if (nn == 0) {
+                return (success ? n : 0);
+            }
+            n = nn;
+            success = true;
+        }
+        if (n > s + 2) {
+            p = 2 * s - n + 1;
+            hgcd_matrix m1;
+            nn = hgcd(a + p, b + p, n - p, m1);
+            if (nn != 0) {
+                n = adjust(m1, p + nn, a, b, p);
+                m.mul(m1);
+                success = true;
+            }
+        }
+    }
+    for (;;) {
+        size_t nn = hgcd_step(n, a, b, s, m);
+        if (nn == 0) {
+            return (success ? n : 0);
+        }
+        n = nn;
+        success = true;
+    }
+}
+
+double_limb_t gcd_2(double_limb_t a, double_limb_t b)
+{
+    while (b != 0) {
+        double_limb_t r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+// Euclid's algorithm on single limbs until one of them is zero, the
+// entries of M1 stay below the larger input
+matrix1 euclid_1(limb_t &a, limb_t &b)
+{
+    matrix1 m = {{{1, 0}, {0, 1}}};
+    while (a != 0 && b != 0) {
+        if (a >= b) {
+            limb_t q = a / b;
+            a -= q * b;
+            m.u[0][1] += q * m.u[0][0];
+            m.u[1][1] += q * m.u[1][0];
+        } else {
+            limb_t q = b / a;
+            b -= q * a;
+            m.u[0][0] += q * m.u[0][1];
+            m.u[1][0] += q * m.u[1][1];
+        }
+    }
+    return m;
+}
+
+// Euclid's algorithm on u and v of n limbs, returns 0 once one of them is
+// zero or both are equal; without a matrix to collect the steps in, it
+// stops early when both fit in two limbs and returns their size
+size_t reduce(limb_t *u, limb_t *v, size_t n, hgcd_matrix *m)
+{
+    std::vector<limb_t> scratch(2 * n);
+    while (n >= GCD_DC_THRESHOLD) {
+        // a reduction of the top third brings both down by about a third
+        size_t p = 2 * n / 3;
+        hgcd_matrix m1;
+        size_t nn = hgcd(u + p, v + p, n - p, m1);
+        if (nn != 0) {
+            n = adjust(m1, p + nn, u, v, p);
+            if (m != nullptr) {
+                m->mul(m1);
+            }
+        } else {
+            n = subdiv_step(u, v, n, 0, m);
+        }
+    }
+    while (n > 2 || (m != nullptr && n != 0)) {
+        if (n == 1) {
+            m->mul(euclid_1(u[0], v[0]));
+            return 0;
+        }
+        limb_t ah, al, bh, bl;
+        matrix1 m1;
+        top_limbs(u, v, n, &ah, &al, &bh, &bl);
+        if (hgcd2(ah, al, bh, bl, m1)) {
+            n = apply_inverse(m1, u, v, n, scratch.data());
+            if (m != nullptr) {
+                m->mul(m1);
+            }
+        } else {
+            n = subdiv_step(u, v, n, 0, m);
+        }
+    }
+    return n;
+}
+}
+
+size_t gcd(limb_t *g, limb_t const *a, size_t an, limb_t const *b, size_t bn)
+{
+    std::vector<limb_t> u(bn), v(b, b + bn);
+    if (an > bn || compare_n(a, b, bn) >= 0) {
+        std::vector<limb_t> q(an - bn + 1);
+        divrem(q.data(), u.data(), a, an, b, bn);
+    } else {
+        std::copy(a, a + an, u.begin());
+    }
+    size_t n = reduce(u.data(), v.data(), bn, nullptr);
+    if (n == 0) {
+        // either one of them is zero or both are equal
+        std::vector<limb_t> const &w = (normalized_size(u.data(), bn) != 0 ? u : v);
+        size_t wn = normalized_size(w.data(), bn);
+        std::copy(w.begin(), w.begin() + wn, g);
+        return wn;
+    }
+    double_limb_t x = u[0], y = v[0];
+    if (n == 2) {
+        x |= static_cast<double_limb_t>(u[1]) << LIMB_BITS;
+        y |= static_cast<double_limb_t>(v[1]) << LIMB_BITS;
+    }
+    double_limb_t d = gcd_2(x, y);
+    g[0] = static_cast<limb_t>(d);
+    if ((d >> LIMB_BITS) == 0) {
+        return 1;
+    }
+    g[1] = static_cast<limb_t>(d >> LIMB_BITS);
+    return 2;
+}
+
+size_t gcdext(limb_t *g, limb_t *t, ptrdiff_t *tn, limb_t const *a, size_t an, limb_t const *b, size_t bn)
+{
+    std::vector<limb_t> u(bn), v(b, b + bn);
+    hgcd_matrix m;
+    if (an > bn || compare_n(a, b, bn) >= 0) {
+        // (a; b) = (1 q; 0 1) (a mod b; b)
+        std::vector<limb_t> q(an - bn + 1);
+        divrem(q.data(), u.data(), a, an, b, bn);
+        size_t qn = normalized_size(q.data(), q.size());
+        if (qn != 0) {
+            m.update_q(q.data(), qn, 1);
+        }
+    } else {
+        std::copy(a, a + an, u.begin());
+    }
+    reduce(u.data(), v.data(), bn, &m);
+
+    // g is alpha = u11 a - u01 b unless alpha vanished, then it is
+    // beta = u00 b - u10 a
+    bool alpha = (normalized_size(u.data(), bn) != 0);
+    std::vector<limb_t> const &w = (alpha ? u : v);
+    size_t gn = normalized_size(w.data(), bn);
+    std::copy(w.begin(), w.begin() + gn, g);
+    std::vector<limb_t> const &c = m.u[0][alpha ? 1 : 0];
+    size_t cn = normalized_size(c.data(), m.n);
+    std::copy(c.begin(), c.begin() + cn, t);
+    *tn = (alpha ? -1 : 1) * static_cast<ptrdiff_t>(cn);
+    return gn;
+}
@@ -0,0 +1,13 @@
+#ifndef LIMB_H
+#define LIMB_H
+
+#include <cstdint>
+#include <cstddef>
+
+typedef uint64_t limb_t;
+__extension__ typedef unsigned __int128 double_limb_t;
+
+constexpr int LIMB_BITS = 64;
+constexpr limb_t LIMB_MAX = UINT64_MAX;
+
+#endif // LIMB_H
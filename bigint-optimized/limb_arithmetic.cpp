@@ -0,0 +1,616 @@
+#include "limb_arithmetic.h"
+
+#include <algorithm>
+#include <vector>
+
+#ifdef BIGINT_ASM_KERNELS
+// adc/sbb and mul chains from asm/limb_kernels.asm, same contracts as the
+// C++ loops below
+extern "C" {
+limb_t asm_add_n(limb_t *, limb_t const *, limb_t const *, size_t);
+limb_t asm_sub_n(limb_t *, limb_t const *, limb_t const *, size_t);
+limb_t asm_mul_1(limb_t *, limb_t const *, size_t, limb_t);
+limb_t asm_addmul_1(limb_t *, limb_t const *, size_t, limb_t);
+limb_t asm_submul_1(limb_t *, limb_t const *, size_t, limb_t);
+limb_t asm_divrem_1(limb_t *, limb_t const *, size_t, limb_t);
+}
+#endif
+
+namespace {
+bool generic_only = false;
+}
+
+void force_generic_kernels(bool on)
+{
+    generic_only = on;
+}
+
+bool generic_kernels_forced()
+{
+    return generic_only;
+}
+
+limb_t add_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n)
+{
+#ifdef BIGINT_ASM_KERNELS
+    return asm_add_n(r, a, b, n);
+#else
+    limb_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        double_limb_t sum = static_cast<double_limb_t>(a[i]) + b[i] + carry;
+        r[i] = static_cast<limb_t>(sum);
+        carry = static_cast<limb_t>(sum >> LIMB_BITS);
+    }
+    return carry;
+#endif
+}
+
+limb_t add_1(limb_t *r, limb_t const *a, size_t n, limb_t b)
+{
+    size_t i = 0;
+    for (; i < n && b != 0; i++) {
+        limb_t sum = a[i] + b;
+        b = (sum < b ? 1 : 0);
+        r[i] = sum;
+    }
+    if (r != a) {
+        std::copy(a + i, a + n, r + i);
+    }
+    return b;
+}
+
+limb_t add(limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn)
+{
+    limb_t carry = add_n(r, a, b, bn);
+    return add_1(r + bn, a + bn, an - bn, carry);
+}
+
+limb_t sub_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n)
+{
+#ifdef BIGINT_ASM_KERNELS
+    return asm_sub_n(r, a, b, n);
+#else
+    limb_t borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        double_limb_t diff = static_cast<double_limb_t>(a[i]) - b[i] - borrow;
+        r[i] = static_cast<limb_t>(diff);
+        borrow = static_cast<limb_t>(diff >> LIMB_BITS) & 1;
+    }
+    return borrow;
+#endif
+}
+
+limb_t sub_1(limb_t *r, limb_t const *a, size_t n, limb_t b)
+{
+    size_t i = 0;
+    for (; i < n && b != 0; i++) {
+        limb_t cur = a[i];
+        r[i] = cur - b;
+        b = (cur < b ? 1 : 0);
+    }
+    if (r != a) {
+        std::copy(a + i, a + n, r + i);
+    }
+    return b;
+}
+
+limb_t sub(limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn)
+{
+    limb_t borrow = sub_n(r, a, b, bn);
+    return sub_1(r + bn, a + bn, an - bn, borrow);
+}
+
+int compare_n(limb_t const *a, limb_t const *b, size_t n)
+{
+    while (n != 0) {
+        n--;
+        if (a[n] != b[n]) {
+            return a[n] < b[n] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+size_t normalized_size(limb_t const *a, size_t n)
+{
+    while (n != 0 && a[n - 1] == 0) {
+        n--;
+    }
+    return n;
+}
+
+limb_t mul_1(limb_t *r, limb_t const *a, size_t n, limb_t b)
+{
+#ifdef BIGINT_ASM_KERNELS
+    return asm_mul_1(r, a, n, b);
+#else
+    limb_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        double_limb_t cur = static_cast<double_limb_t>(a[i]) * b + carry;
+        r[i] = static_cast<limb_t>(cur);
+        carry = static_cast<limb_t>(cur >> LIMB_BITS);
+    }
+    return carry;
+#endif
+}
+
+limb_t addmul_1(limb_t *r, limb_t const *a, size_t n, limb_t b)
+{
+#ifdef BIGINT_ASM_KERNELS
+    return asm_addmul_1(r, a, n, b);
+#else
+    limb_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        double_limb_t cur = static_cast<double_limb_t>(a[i]) * b + r[i] + carry;
+        r[i] = static_cast<limb_t>(cur);
+        carry = static_cast<limb_t>(cur >> LIMB_BITS);
+    }
+    return carry;
+#endif
+}
+
+limb_t submul_1(limb_t *r, limb_t const *a, size_t n, limb_t b)
+{
+#ifdef BIGINT_ASM_KERNELS
+    return asm_submul_1(r, a, n, b);
+#else
+    limb_t borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        double_limb_t cur = static_cast<double_limb_t>(a[i]) * b + borrow;
+        limb_t low = static_cast<limb_t>(cur);
+        borrow = static_cast<limb_t>(cur >> LIMB_BITS) + (r[i] < low ? 1 : 0);
+        r[i] -= low;
+    }
+    return borrow;
+#endif
+}
+
+limb_t divrem_1(limb_t *q, limb_t const *a, size_t n, limb_t d)
+{
+#ifdef BIGINT_ASM_KERNELS
+    return asm_divrem_1(q, a, n, d);
+#else
+    double_limb_t rem = 0;
+    for (size_t i = n; i != 0; i--) {
+        double_limb_t cur = (rem << LIMB_BITS) | a[i - 1];
+        q[i - 1] = static_cast<limb_t>(cur / d);
+        rem = cur % d;
+    }
+    return static_cast<limb_t>(rem);
+#endif
+}
+
+limb_t lshift(limb_t *r, limb_t const *a, size_t n, unsigned cnt)
+{
+    limb_t out = a[n - 1] >> (LIMB_BITS - cnt);
+    for (size_t i = n - 1; i != 0; i--) {
+        r[i] = (a[i] << cnt) | (a[i - 1] >> (LIMB_BITS - cnt));
+    }
+    r[0] = a[0] << cnt;
+    return out;
+}
+
+limb_t rshift(limb_t *r, limb_t const *a, size_t n, unsigned cnt)
+{
+    limb_t out = a[0] << (LIMB_BITS - cnt);
+    for (size_t i = 0; i + 1 < n; i++) {
+        r[i] = (a[i] >> cnt) | (a[i + 1] << (LIMB_BITS - cnt));
+    }
+    r[n - 1] = a[n - 1] >> cnt;
+    return out;
+}
+
+// multiplies by the inverse of 3 modulo B instead of dividing
+void divexact_by3(limb_t *r, limb_t const *a, size_t n)
+{
+    constexpr limb_t inverse = LIMB_MAX / 3 * 2 + 1;
+    limb_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        limb_t cur = a[i];
+        limb_t borrow = (cur < carry ? 1 : 0);
+        cur -= carry;
+        limb_t q = cur * inverse;
+        r[i] = q;
+        carry = borrow + static_cast<limb_t>((static_cast<double_limb_t>(q) * 3) >> LIMB_BITS);
+    }
+}
+
+void mul_basecase(limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn)
+{
+#if defined(__x86_64__)
+    if (cpu_has_adx()) {
+        mul_basecase_adx(r, a, an, b, bn);
+        return;
+    }
+#endif
+    mul_basecase_generic(r, a, an, b, bn);
+}
+
+void mul_basecase_generic(limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn)
+{
+    r[an] = mul_1(r, a, an, b[0]);
+    for (size_t j = 1; j < bn; j++) {
+        r[an + j] = addmul_1(r + j, a, an, b[j]);
+    }
+}
+
+// r[0, 2n) += a[i]^2 B^2i, the doubled cross products leave room for it
+void add_diagonal(limb_t *r, limb_t const *a, size_t n)
+{
+    limb_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        double_limb_t square = static_cast<double_limb_t>(a[i]) * a[i];
+        double_limb_t low = static_cast<double_limb_t>(r[2 * i]) + static_cast<limb_t>(square) + carry;
+        double_limb_t high =
+            static_cast<double_limb_t>(r[2 * i + 1]) + static_cast<limb_t>(square >> LIMB_BITS) + (low >> LIMB_BITS);
+        r[2 * i] = static_cast<limb_t>(low);
+        r[2 * i + 1] = static_cast<limb_t>(high);
+        carry = static_cast<limb_t>(high >> LIMB_BITS);
+    }
+}
+
+void sqr_basecase(limb_t *r, limb_t const *a, size_t n)
+{
+#if defined(__x86_64__)
+    if (cpu_has_adx()) {
+        sqr_basecase_adx(r, a, n);
+        return;
+    }
+#endif
+    sqr_basecase_generic(r, a, n);
+}
+
+void sqr_basecase_generic(limb_t *r, limb_t const *a, size_t n)
+{
+    r[0] = 0;
+    r[2 * n - 1] = 0;
+    if (n > 1) {
+        r[n] = mul_1(r + 1, a + 1, n - 1, a[0]);
+        for (size_t i = 1; i + 1 < n; i++) {
+            r[n + i] = addmul_1(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+        }
+        r[2 * n - 1] = lshift(r + 1, r + 1, 2 * n - 2, 1);
+    }
+    add_diagonal(r, a, n);
+}
+
+namespace {
+// r[0, an) = |a - b| for an >= bn, returns true if a < b
+bool abs_diff(limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn)
+{
+    size_t top = an;
+    while (top > bn && a[top - 1] == 0) {
+        top--;
+    }
+    if (top == bn && compare_n(a, b, bn) < 0) {
+        sub_n(r, b, a, bn);
+        std::fill(r + bn, r + an, 0);
+        return true;
+    }
+    sub(r, a, an, b, bn);
+    return false;
+}
+
+void mul_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n, limb_t *scratch)
+{
+    if (n < KARATSUBA_THRESHOLD) {
+        mul_basecase(r, a, n, b, n);
+#if defined(__x86_64__)
+    } else if (n < IFMA_KARATSUBA_THRESHOLD && cpu_has_ifma()) {
+        mul_ifma(r, a, n, b, n);
+#endif
+    } else {
+        karatsuba_mul(r, a, b, n, scratch);
+    }
+}
+
+void sqr_n(limb_t *r, limb_t const *a, size_t n, limb_t *scratch)
+{
+    if (n < SQR_KARATSUBA_THRESHOLD) {
+        sqr_basecase(r, a, n);
+#if defined(__x86_64__)
+    } else if (n < IFMA_KARATSUBA_THRESHOLD && cpu_has_ifma()) {
+        mul_ifma(r, a, n, a, n);
+#endif
+    } else {
+        karatsuba_sqr(r, a, n, scratch);
+    }
+}
+}
+
+size_t karatsuba_scratch_size(size_t n)
+{
+    if (n < KARATSUBA_THRESHOLD) {
+        return 0;
+    }
+    size_t h = n - n / 2;
+    return 6 * h + 1 + karatsuba_scratch_size(h);
+}
+
+// a = a0 + a1 * B^h, b = b0 + b1 * B^h, the middle term is computed as
+// a0 * b0 + a1 * b1 -+ |a0 - a1| * |b0 - b1| so that nothing overflows
+void karatsuba_mul(limb_t *r, limb_t const *a, limb_t const *b, size_t n, limb_t *scratch)
+{
+    size_t h = n - n / 2, l = n - h;
+    limb_t *da = scratch, *db = da + h, *zm = db + h, *t = zm + 2 * h;
+    limb_t *next = t + 2 * h + 1;
+
+    bool negative = abs_diff(da, a, h, a + h, l) != abs_diff(db, b, h, b + h, l);
+
+    mul_n(r, a, b, h, next);
+    mul_n(r + 2 * h, a + h, b + h, l, next);
+    mul_n(zm, da, db, h, next);
+
+    std::copy(r, r + 2 * h, t);
+    t[2 * h] = add(t, t, 2 * h, r + 2 * h, 2 * l);
+    if (negative) {
+        t[2 * h] += add_n(t, t, zm, 2 * h);
+    } else {
+        t[2 * h] -= sub_n(t, t, zm, 2 * h);
+    }
+    add(r + h, r + h, 2 * n - h, t, 2 * h + 1);
+}
+
+// the middle term a0^2 + a1^2 - (a0 - a1)^2 never goes negative; uses
+// less scratch than karatsuba_mul
+void karatsuba_sqr(limb_t *r, limb_t const *a, size_t n, limb_t *scratch)
+{
+    size_t h = n - n / 2, l = n - h;
+    limb_t *da = scratch, *zm = da + h, *t = zm + 2 * h;
+    limb_t *next = t + 2 * h + 1;
+
+    abs_diff(da, a, h, a + h, l);
+
+    sqr_n(r, a, h, next);
+    sqr_n(r + 2 * h, a + h, l, next);
+    sqr_n(zm, da, h, next);
+
+    std::copy(r, r + 2 * h, t);
+    t[2 * h] = add(t, t, 2 * h, r + 2 * h, 2 * l);
+    t[2 * h] -= sub_n(t, t, zm, 2 * h);
+    add(r + h, r + h, 2 * n - h, t, 2 * h + 1);
+}
+
+namespace {
+void mul_balanced(limb_t *r, limb_t const *a, limb_t const *b, size_t n)
+{
+    if (n < KARATSUBA_THRESHOLD) {
+        mul_basecase(r, a, n, b, n);
+#if defined(__x86_64__)
+    } else if (n < IFMA_KARATSUBA_THRESHOLD && cpu_has_ifma()) {
+        mul_ifma(r, a, n, b, n);
+#endif
+    } else if (n < TOOM3_THRESHOLD) {
+        std::vector<limb_t> scratch(karatsuba_scratch_size(n));
+        karatsuba_mul(r, a, b, n, scratch.data());
+    } else if (n < NTT_THRESHOLD || !ntt_fits(n, n)) {
+        toom3_mul(r, a, b, n);
+    } else {
+        ntt_mul(r, a, n, b, n);
+    }
+}
+
+void sqr_balanced(limb_t *r, limb_t const *a, size_t n)
+{
+    if (n < SQR_KARATSUBA_THRESHOLD) {
+        sqr_basecase(r, a, n);
+#if defined(__x86_64__)
+    } else if (n < IFMA_KARATSUBA_THRESHOLD && cpu_has_ifma()) {
+        mul_ifma(r, a, n, a, n);
+#endif
+    } else if (n < SQR_TOOM3_THRESHOLD) {
+        std::vector<limb_t> scratch(karatsuba_scratch_size(n));
+        karatsuba_sqr(r, a, n, scratch.data());
+    } else if (n < NTT_THRESHOLD || !ntt_fits(n, n)) {
+        toom3_sqr(r, a, n);
+    } else {
+        ntt_mul(r, a, n, a, n);
+    }
+}
+
+// r[off, rn) += c, where c may carry high zero limbs that do not fit
+void add_at(limb_t *r, size_t rn, size_t off, limb_t const *c, size_t cn)
+{
+    add(r + off, r + off, rn - off, c, normalized_size(c, cn));
+}
+
+// splits a into pieces of bn limbs, every piece is a balanced product
+void mul_chunked(limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn)
+{
+    std::vector<limb_t> tmp(2 * bn);
+    mul_balanced(r, a, b, bn);
+    size_t pos = bn;
+    for (; pos + bn <= an; pos += bn) {
+        mul_balanced(tmp.data(), a + pos, b, bn);
+        limb_t carry = add_n(r + pos, r + pos, tmp.data(), bn);
+        std::copy(tmp.begin() + bn, tmp.end(), r + pos + bn);
+        add_1(r + pos + bn, r + pos + bn, bn, carry);
+    }
+    if (pos < an) {
+        size_t rest = an - pos;
+        mul(tmp.data(), b, bn, a + pos, rest);
+        std::fill(r + pos + bn, r + an + bn, 0);
+        add(r + pos, r + pos, an + bn - pos, tmp.data(), bn + rest);
+    }
+}
+}
+
+namespace {
+// p1 = x(1), pm = |x(-1)| and p2 = x(2) for x = x0 + x1 t + x2 t^2 with
+// pieces of k, k and last limbs, returns true if x(-1) < 0
+bool toom3_evaluate(limb_t *p1, limb_t *pm, limb_t *p2, limb_t const *x, size_t k, size_t last)
+{
+    limb_t const *x0 = x, *x1 = x + k, *x2 = x + 2 * k;
+    p1[k] = add(p1, x0, k, x2, last);
+    bool negative = abs_diff(pm, p1, k + 1, x1, k);
+    p1[k] += add_n(p1, p1, x1, k);
+    std::copy(x0, x0 + k, p2);
+    p2[k] = addmul_1(p2, x1, k, 2);
+    limb_t carry = addmul_1(p2, x2, last, 4);
+    add_1(p2 + last, p2 + last, k + 1 - last, carry);
+    return negative;
+}
+
+// r[0, 2k) = v0 and r[4k, 2n) = vinf on entry, the other three values
+// have len = 2k + 2 limbs and v(-1) comes as its absolute value; keeps
+// every intermediate value non-negative
+void toom3_interpolate(limb_t *r, size_t n, size_t k, limb_t *v1, limb_t *vm, limb_t *v2, bool negative)
+{
+    size_t last = n - 2 * k, len = 2 * k + 2;
+    limb_t const *v0 = r, *vinf = r + 4 * k;
+
+    // vm = (v1 - v(-1)) / 2 = c1 + c3, v1 = v1 - vm = c0 + c2 + c4
+    if (negative) {
+        add_n(vm, v1, vm, len);
+    } else {
+        sub_n(vm, v1, vm, len);
+    }
+    rshift(vm, vm, len, 1);
+    sub_n(v1, v1, vm, len);
+    sub(v1, v1, len, v0, 2 * k);
+    sub(v1, v1, len, vinf, 2 * last);
+
+    // v2 = (v2 - c0 - 4 c2 - 16 c4) / 2 - (c1 + c3) = 3 c3
+    sub(v2, v2, len, v0, 2 * k);
+    submul_1(v2, v1, len, 4);
+    limb_t borrow = submul_1(v2, vinf, 2 * last, 16);
+    sub_1(v2 + 2 * last, v2 + 2 * last, len - 2 * last, borrow);
+    rshift(v2, v2, len, 1);
+    sub_n(v2, v2, vm, len);
+    divexact_by3(v2, v2, len);
+    sub_n(vm, vm, v2, len);
+
+    std::fill(r + 2 * k, r + 4 * k, 0);
+    add_at(r, 2 * n, k, vm, len);
+    add_at(r, 2 * n, 2 * k, v1, len);
+    add_at(r, 2 * n, 3 * k, v2, len);
+}
+}
+
+// evaluates at 0, 1, -1, 2, inf and interpolates
+void toom3_mul(limb_t *r, limb_t const *a, limb_t const *b, size_t n)
+{
+    size_t k = (n + 2) / 3, last = n - 2 * k, len = 2 * k + 2;
+    std::vector<limb_t> buffer(6 * (k + 1) + 3 * len);
+    limb_t *a1 = buffer.data(), *am = a1 + k + 1, *a2 = am + k + 1;
+    limb_t *b1 = a2 + k + 1, *bm = b1 + k + 1, *b2 = bm + k + 1;
+    limb_t *v1 = b2 + k + 1, *vm = v1 + len, *v2 = vm + len;
+
+    bool negative = toom3_evaluate(a1, am, a2, a, k, last) != toom3_evaluate(b1, bm, b2, b, k, last);
+
+    mul_balanced(r, a, b, k);
+    mul_balanced(r + 4 * k, a + 2 * k, b + 2 * k, last);
+    mul_balanced(v1, a1, b1, k + 1);
+    mul_balanced(vm, am, bm, k + 1);
+    mul_balanced(v2, a2, b2, k + 1);
+    toom3_interpolate(r, n, k, v1, vm, v2, negative);
+}
+
+// five squarings of the evaluated pieces, v(-1) = x(-1)^2 is never negative
+void toom3_sqr(limb_t *r, limb_t const *a, size_t n)
+{
+    size_t k = (n + 2) / 3, last = n - 2 * k, len = 2 * k + 2;
+    std::vector<limb_t> buffer(3 * (k + 1) + 3 * len);
+    limb_t *a1 = buffer.data(), *am = a1 + k + 1, *a2 = am + k + 1;
+    limb_t *v1 = a2 + k + 1, *vm = v1 + len, *v2 = vm + len;
+
+    toom3_evaluate(a1, am, a2, a, k, last);
+
+    sqr_balanced(r, a, k);
+    sqr_balanced(r + 4 * k, a + 2 * k, last);
+    sqr_balanced(v1, a1, k + 1);
+    sqr_balanced(vm, am, k + 1);
+    sqr_balanced(v2, a2, k + 1);
+    toom3_interpolate(r, n, k, v1, vm, v2, false);
+}
+
+// a is split into three pieces and b into two, evaluated at 0, 1, -1, inf
+void toom32_mul(limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn)
+{
+    size_t k = std::max((an + 2) / 3, (bn + 1) / 2);
+    size_t alast = an - 2 * k, blast = bn - k, len = 2 * k + 2;
+    std::vector<limb_t> buffer(3 * (k + 1) + k + 2 * len);
+    limb_t *a1 = buffer.data(), *am = a1 + k + 1, *b1 = am + k + 1, *bm = b1 + k + 1;
+    limb_t *v1 = bm + k, *vm = v1 + len;
+
+    a1[k] = add(a1, a, k, a + 2 * k, alast);
+    bool negative = abs_diff(am, a1, k + 1, a + k, k);
+    a1[k] += add_n(a1, a1, a + k, k);
+    b1[k] = add(b1, b, k, b + k, blast);
+    negative ^= abs_diff(bm, b, k, b + k, blast);
+
+    mul_balanced(r, a, b, k);
+    std::fill(r + 2 * k, r + 3 * k, 0);
+    if (alast >= blast) {
+        mul(r + 3 * k, a + 2 * k, alast, b + k, blast);
+    } else {
+        mul(r + 3 * k, b + k, blast, a + 2 * k, alast);
+    }
+    mul_balanced(v1, a1, b1, k + 1);
+    mul(vm, am, k + 1, bm, k);
+    vm[len - 1] = 0;
+    limb_t const *v0 = r, *vinf = r + 3 * k;
+
+    if (negative) {
+        add_n(vm, v1, vm, len);
+    } else {
+        sub_n(vm, v1, vm, len);
+    }
+    rshift(vm, vm, len, 1);
+    sub_n(v1, v1, vm, len);
+    sub(v1, v1, len, v0, 2 * k);
+    sub(vm, vm, len, vinf, alast + blast);
+
+    add_at(r, an + bn, k, vm, len);
+    add_at(r, an + bn, 2 * k, v1, len);
+}
+
+void mul(limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn)
+{
+    if (bn < KARATSUBA_THRESHOLD) {
+        mul_basecase(r, a, an, b, bn);
+    } else if (an == bn) {
+        mul_balanced(r, a, b, an);
+    } else if (bn >= NTT_THRESHOLD && ntt_fits(an, bn)) {
+        ntt_mul(r, a, an, b, bn);
+    } else if (an >= 2 * bn) {
+        mul_chunked(r, a, an, b, bn);
+    } else if (4 * an < 5 * bn) {
+        std::vector<limb_t> padded(b, b + bn);
+        padded.resize(an);
+        std::vector<limb_t> tmp(2 * an);
+        mul_balanced(tmp.data(), a, padded.data(), an);
+        std::copy(tmp.begin(), tmp.begin() + an + bn, r);
+    } else if (bn >= TOOM3_THRESHOLD) {
+        toom32_mul(r, a, an, b, bn);
+    } else {
+        mul_chunked(r, a, an, b, bn);
+    }
+}
+
+void sqr(limb_t *r, limb_t const *a, size_t n)
+{
+    sqr_balanced(r, a, n);
+}
+
+size_t pow(limb_t *r, limb_t const *a, size_t an, limb_t e, limb_t *scratch)
+{
+    // the running power moves between r and scratch on every step
+    limb_t *x = r, *y = scratch;
+    std::copy(a, a + an, x);
+    size_t xn = an;
+    for (int i = LIMB_BITS - 2 - __builtin_clzll(e); i >= 0; i--) {
+        sqr(y, x, xn);
+        xn = normalized_size(y, 2 * xn);
+        std::swap(x, y);
+        if (((e >> i) & 1) != 0) {
+            mul(y, x, xn, a, an);
+            xn = normalized_size(y, xn + an);
+            std::swap(x, y);
+        }
+    }
+    if (x != r) {
+        std::copy(x, x + xn, r);
+    }
+    return xn;
+}
@@ -0,0 +1,189 @@
+#ifndef LIMB_ARITHMETIC_H
+#define LIMB_ARITHMETIC_H
+
+#include "limb.h"
+
+#include <vector>
+
+// Kernels working on little-endian limb spans. Unless stated otherwise
+// the result span must not overlap the operands, sizes are in limbs and
+// the returned limb is the carry (or borrow) out of the top.
+
+constexpr size_t KARATSUBA_THRESHOLD = 32;
+constexpr size_t TOOM3_THRESHOLD = 200;
+// above TOOM3_THRESHOLD, see mul_ifma
+constexpr size_t IFMA_KARATSUBA_THRESHOLD = 256;
+constexpr size_t SQR_KARATSUBA_THRESHOLD = 48;
+constexpr size_t SQR_TOOM3_THRESHOLD = 600;
+constexpr size_t NTT_THRESHOLD = 100000;
+constexpr size_t DIV_BZ_THRESHOLD = 60;
+constexpr size_t DIV_NEWTON_THRESHOLD = 16000;
+constexpr size_t REDC_MUL_THRESHOLD = 40;
+constexpr size_t HGCD_THRESHOLD = 120;
+constexpr size_t GCD_DC_THRESHOLD = 400;
+
+limb_t add_n(limb_t *, limb_t const *, limb_t const *, size_t);
+limb_t add(limb_t *, limb_t const *, size_t, limb_t const *, size_t);
+limb_t add_1(limb_t *, limb_t const *, size_t, limb_t);
+limb_t sub_n(limb_t *, limb_t const *, limb_t const *, size_t);
+limb_t sub(limb_t *, limb_t const *, size_t, limb_t const *, size_t);
+limb_t sub_1(limb_t *, limb_t const *, size_t, limb_t);
+int compare_n(limb_t const *, limb_t const *, size_t);
+// size of a without its high zero limbs, 0 if every limb is zero
+size_t normalized_size(limb_t const *, size_t);
+
+limb_t mul_1(limb_t *, limb_t const *, size_t, limb_t);
+limb_t addmul_1(limb_t *, limb_t const *, size_t, limb_t);
+limb_t submul_1(limb_t *, limb_t const *, size_t, limb_t);
+
+// q = a / d, returns a % d, q may coincide with a
+limb_t divrem_1(limb_t *, limb_t const *, size_t, limb_t);
+
+// shifts by 0 < cnt < LIMB_BITS, returning the bits shifted out;
+// lshift may work in place with r >= a, rshift with r <= a
+limb_t lshift(limb_t *, limb_t const *, size_t, unsigned);
+limb_t rshift(limb_t *, limb_t const *, size_t, unsigned);
+void divexact_by3(limb_t *, limb_t const *, size_t);
+
+struct bit_and
+{
+    template <typename T> T operator()(T a, T b) const { return a & b; }
+};
+
+struct bit_or
+{
+    template <typename T> T operator()(T a, T b) const { return a | b; }
+};
+
+struct bit_xor
+{
+    template <typename T> T operator()(T a, T b) const { return a ^ b; }
+};
+
+// r[i] = op(a[i] ^ ma, b[i] ^ mb) ^ mr, r may coincide with a or b;
+// instantiated for bit_and, bit_or and bit_xor
+template <typename Op>
+void bitwise_n(limb_t *, limb_t const *, limb_t const *, size_t, limb_t, limb_t, limb_t);
+
+// for tests: while set, the dispatchers take the portable kernels as on a
+// CPU without ADX, IFMA or AVX2; only flip it while nothing else computes
+void force_generic_kernels(bool);
+bool generic_kernels_forced();
+
+// schoolbook product r[0, an + bn) = a * b for an >= bn >= 1; on x86-64
+// CPUs with BMI2 and ADX the mulx/adcx/adox rows are picked at startup
+void mul_basecase(limb_t *, limb_t const *, size_t, limb_t const *, size_t);
+void mul_basecase_generic(limb_t *, limb_t const *, size_t, limb_t const *, size_t);
+#if defined(__x86_64__)
+bool cpu_has_adx();
+void mul_basecase_adx(limb_t *, limb_t const *, size_t, limb_t const *, size_t);
+#endif
+
+// r[0, 2n) += a[i]^2 B^2i for every i
+void add_diagonal(limb_t *, limb_t const *, size_t);
+// r[0, 2n) = a^2 computing every cross product a[i] a[j] once, dispatched
+// like mul_basecase
+void sqr_basecase(limb_t *, limb_t const *, size_t);
+void sqr_basecase_generic(limb_t *, limb_t const *, size_t);
+#if defined(__x86_64__)
+void sqr_basecase_adx(limb_t *, limb_t const *, size_t);
+#endif
+size_t karatsuba_scratch_size(size_t);
+void karatsuba_mul(limb_t *, limb_t const *, limb_t const *, size_t, limb_t *);
+void karatsuba_sqr(limb_t *, limb_t const *, size_t, limb_t *);
+void toom3_mul(limb_t *, limb_t const *, limb_t const *, size_t);
+void toom3_sqr(limb_t *, limb_t const *, size_t);
+void toom32_mul(limb_t *, limb_t const *, size_t, limb_t const *, size_t);
+#if defined(__x86_64__)
+// product through radix 2^52 digits and AVX-512 IFMA column sums, the
+// 64-bit column accumulators limit bn to 3300 limbs. When the CPU has
+// IFMA it takes every balanced product and square from the end of the
+// basecase up to IFMA_KARATSUBA_THRESHOLD limbs, past TOOM3_THRESHOLD on
+// purpose since it still beats Toom-3 at 256 limbs. Products then go
+// from it straight to Toom-3, squares to Karatsuba up to
+// SQR_TOOM3_THRESHOLD.
+bool cpu_has_ifma();
+void mul_ifma(limb_t *, limb_t const *, size_t, limb_t const *, size_t);
+#endif
+bool ntt_fits(size_t, size_t);
+void ntt_mul(limb_t *, limb_t const *, size_t, limb_t const *, size_t);
+
+// r[0, an + bn) = a * b, requires an >= bn >= 1
+void mul(limb_t *, limb_t const *, size_t, limb_t const *, size_t);
+// r[0, 2n) = a^2 through the squaring counterparts of the mul tiers
+void sqr(limb_t *, limb_t const *, size_t);
+// r = a^e for e >= 1 and a with a non-zero top limb, returns the size of
+// r; r and scratch both need room for e * bits(a) / LIMB_BITS + 2 limbs
+// and take turns holding the running power while e is scanned from the top
+size_t pow(limb_t *, limb_t const *, size_t, limb_t, limb_t *);
+
+// {np, nn} / {d, dn} for a normalized divisor: the low nn - dn quotient
+// limbs go to q, the top one is returned and the remainder is left in
+// np[0, dn)
+limb_t divrem_basecase(limb_t *, limb_t *, size_t, limb_t const *, size_t);
+
+// q[0, an - bn + 1) = a / b, r[0, bn) = a % b, requires an >= bn and a
+// non-zero top limb of b; Burnikel-Ziegler above DIV_BZ_THRESHOLD and
+// Newton reciprocal above DIV_NEWTON_THRESHOLD
+void divrem(limb_t *, limb_t *, limb_t const *, size_t, limb_t const *, size_t);
+
+// Fixed-point reciprocal of a divisor computed by Newton iteration, so
+// that every division by it costs a couple of multiplications. Keep it
+// around when dividing by the same value repeatedly.
+class reciprocal
+{
+public:
+    reciprocal(limb_t const *, size_t);
+
+    size_t size() const;
+
+    // same contract as divrem with this divisor
+    void divrem(limb_t *, limb_t *, limb_t const *, size_t) const;
+
+private:
+    std::vector<limb_t> divisor, inverse;
+    unsigned shift;
+};
+
+// Residues modulo an odd m of n limbs in Montgomery form a R mod m with
+// R = B^n, so that a product is reduced without division. Keep it around
+// when working modulo the same value repeatedly; the methods share
+// scratch space, so one object must not be used from several threads.
+class montgomery
+{
+public:
+    montgomery(limb_t const *, size_t);
+
+    size_t size() const;
+
+    // conversions of residues below m, r may coincide with a
+    void to_montgomery(limb_t *, limb_t const *) const;
+    void from_montgomery(limb_t *, limb_t const *) const;
+
+    // r = a b R^-1 mod m, r may coincide with a or b
+    void mul(limb_t *, limb_t const *, limb_t const *) const;
+    void sqr(limb_t *, limb_t const *) const;
+
+private:
+    void reduce(limb_t *) const;
+
+    std::vector<limb_t> modulus, inverse, r2;
+    mutable std::vector<limb_t> product, scratch;
+};
+
+// r[0, n) = a^e mod m for an e with a non-zero top limb and m with a
+// non-zero top limb, a may have any length; odd moduli are handled in
+// Montgomery form, a sliding window scans the exponent
+void powmod(limb_t *, limb_t const *, size_t, limb_t const *, size_t, limb_t const *, size_t);
+
+// g = gcd(a, b) for an >= bn >= 1 and a non-zero top limb of b, g has
+// room for bn limbs and its size is returned; Lehmer steps on the top two
+// limbs collect several quotients in single-limb cofactors, above
+// GCD_DC_THRESHOLD half-GCD reductions take out a third of the size at a
+// time through products of cofactor matrices
+size_t gcd(limb_t *, limb_t const *, size_t, limb_t const *, size_t);
+// as gcd, and t[0, an) gets the cofactor of b with g = s a + t b for
+// some s and |t| <= a / g; its size goes to tn, negated for a negative t
+size_t gcdext(limb_t *, limb_t *, ptrdiff_t *, limb_t const *, size_t, limb_t const *, size_t);
+
+#endif // LIMB_ARITHMETIC_H
@@ -0,0 +1,129 @@
+#include "modulus.h"
+#include "limb_arithmetic.h"
+
+#include <stdexcept>
+
+namespace {
+big_integer absolute_value(big_integer const &x)
+{
+    if (x == 0) {
+        throw std::invalid_argument("Modulus is zero");
+    }
+    return (x < 0 ? -x : x);
+}
+
+// r[lo, 2n) holds the columns of a * b from lo on for a, b of n limbs,
+// short of the carry the dropped columns would have sent
+void mul_high(limb_t *r, limb_t const *a, limb_t const *b, size_t n, size_t lo)
+{
+    if (n >= KARATSUBA_THRESHOLD) {
+        mul(r, a, n, b, n);
+        return;
+    }
+    std::fill(r, r + 2 * n, 0);
+    for (size_t j = 0; j < n; j++) {
+        size_t skip = (lo > j ? std::min(lo - j, n) : 0);
+        r[j + n] = addmul_1(r + j + skip, a + skip, n - skip, b[j]);
+    }
+}
+
+// r[0, n) = a * b mod B^n for a of n limbs and b of bn <= n limbs
+void mul_low(limb_t *r, limb_t const *a, size_t n, limb_t const *b, size_t bn)
+{
+    if (bn >= KARATSUBA_THRESHOLD) {
+        std::vector<limb_t> product(n + bn);
+        mul(product.data(), a, n, b, bn);
+        std::copy(product.begin(), product.begin() + n, r);
+        return;
+    }
+    mul_1(r, a, n, b[0]);
+    for (size_t j = 1; j < bn; j++) {
+        addmul_1(r + j, a, n - j, b[j]);
+    }
+}
+}
+
+modulus::modulus(big_integer const &x) : m(absolute_value(x))
+{
+    size_t n = m.digits.size();
+    std::vector<limb_t> power(2 * n + 1), remainder(n);
+    power[2 * n] = 1;
+    mu.resize(n + 2);
+    divrem(mu.data(), remainder.data(), power.data(), 2 * n + 1, m.digits.data(), n);
+    // B^2n / m is B^(n+1) itself for m a power of B, one less keeps it in
+    // n + 1 limbs and the quotient estimate one step further off
+    if (mu[n + 1] != 0) {
+        std::fill(mu.begin(), mu.end(), ~static_cast<limb_t>(0));
+    }
+    mu.resize(n + 1);
+}
+
+big_integer const &modulus::value() const
+{
+    return m;
+}
+
+// x[0, 2n) becomes x mod m in x[0, n): the quotient estimate
+// (x / B^(n-1)) mu / B^(n+1) falls short by at most four, so only the
+// low n + 1 limbs of x - q m are needed
+void modulus::reduce_window(limb_t *x, limb_t *scratch) const
+{
+    size_t n = m.digits.size();
+    limb_t *q = scratch, *qm = q + 2 * n + 2;
+    mul_high(q, x + n - 1, mu.data(), n + 1, n - 1);
+    mul_low(qm, q + n + 1, n + 1, m.digits.data(), n);
+    sub_n(x, x, qm, n + 1);
+    while (x[n] != 0 || compare_n(x, m.digits.data(), n) >= 0) {
+        x[n] -= sub_n(x, x, m.digits.data(), n);
+    }
+}
+
+big_integer modulus::reduce(big_integer const &x) const
+{
+    size_t n = m.digits.size(), xn = x.digits.size();
+    big_integer result;
+    if (xn < n) {
+        result = x;
+        result.sign = false;
+    } else {
+        // windows of 2n limbs from the top, each leaves n limbs behind
+        size_t tn = std::max((xn + n - 1) / n, static_cast<size_t>(2)) * n;
+        std::vector<limb_t> t(tn + 3 * n + 3);
+        std::copy(x.digits.data(), x.digits.data() + xn, t.begin());
+        for (size_t pos = tn - 2 * n;; pos -= n) {
+            reduce_window(t.data() + pos, t.data() + tn);
+            if (pos == 0) {
+                break;
+            }
+        }
+        result.digits.resize(n);
+        std::copy(t.begin(), t.begin() + n, result.digits.data());
+        result.delete_zeros();
+    }
+    if (x.sign && !result.is_zero()) {
+        result.sign = true;
+        result += m;
+    }
+    return result;
+}
+
+big_integer modulus::mulmod(big_integer const &a, big_integer const &b) const
+{
+    return reduce(a * b);
+}
+
+// residues add up to less than 2m, one subtraction is enough for them
+big_integer modulus::addmod(big_integer const &a, big_integer const &b) const
+{
+    big_integer sum = a + b;
+    if (!sum.sign && sum.digits.size() <= m.digits.size()) {
+        if (sum < m) {
+            return sum;
+        }
+        sum -= m;
+        if (sum < m) {
+            return sum;
+        }
+    }
+    return reduce(sum);
+}
@@ -0,0 +1,30 @@
+#ifndef MODULUS_H
+#define MODULUS_H
+
+#include "big_integer.h"
+
+#include <vector>
+
+// Barrett reduction by a fixed non-zero m of n limbs. The reciprocal
+// mu = min(B^2n / |m|, B^(n+1) - 1) of n + 1 limbs is computed once;
+// afterwards a reduction costs two multiplications of n limbs and no
+// long division. Results are the residues in [0, |m|).
+class modulus
+{
+public:
+    explicit modulus(big_integer const&);
+
+    big_integer const& value() const;
+
+    big_integer reduce(big_integer const&) const;
+    big_integer mulmod(big_integer const&, big_integer const&) const;
+    big_integer addmod(big_integer const&, big_integer const&) const;
+
+private:
+    void reduce_window(limb_t *, limb_t *) const;
+
+    big_integer m;
+    std::vector<limb_t> mu;
+};
+
+#endif // MODULUS_H
@@ -0,0 +1,216 @@
+#include "limb_arithmetic.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+// m^-1 mod B for an odd m, every Newton step doubles the correct low
+// bits and m itself is already right in the lowest three
+limb_t limb_inverse(limb_t m)
+{
+    limb_t x = m;
+    for (int i = 0; i < 5; i++) {
+        x *= 2 - m * x;
+    }
+    return x;
+}
+
+// -m^-1 mod B^n, lifted from one limb by x = x (2 - m x) mod B^2k
+std::vector<limb_t> negated_inverse(limb_t const *m, size_t n)
+{
+    std::vector<limb_t> x(n), e(2 * n), t(2 * n);
+    x[0] = limb_inverse(m[0]);
+    for (size_t k = 1; k < n; k *= 2) {
+        // m x = 1 + h B^k, so the next limbs of x are -x h mod B^(k2 - k)
+        size_t k2 = std::min(2 * k, n);
+        mul(e.data(), m, k2, x.data(), k);
+        mul(t.data(), x.data(), k, e.data() + k, k2 - k);
+        for (size_t i = k; i < k2; i++) {
+            x[i] = ~t[i - k];
+        }
+        add_1(x.data() + k, x.data() + k, k2 - k, 1);
+    }
+    for (size_t i = 0; i < n; i++) {
+        x[i] = ~x[i];
+    }
+    add_1(x.data(), x.data(), n, 1);
+    return x;
+}
+
+// residues kept as they are, every product is divided by m through its
+// reciprocal; used for even moduli which have no Montgomery form
+class plain_context
+{
+public:
+    plain_context(limb_t const *m, size_t n) : inverse(m, n), quotient(n + 1), product(2 * n) {}
+
+    size_t size() const
+    {
+        return inverse.size();
+    }
+
+    void mul(limb_t *r, limb_t const *a, limb_t const *b) const
+    {
+        ::mul(product.data(), a, size(), b, size());
+        inverse.divrem(quotient.data(), r, product.data(), 2 * size());
+    }
+
+    void sqr(limb_t *r, limb_t const *a) const
+    {
+        ::sqr(product.data(), a, size());
+        inverse.divrem(quotient.data(), r, product.data(), 2 * size());
+    }
+
+private:
+    reciprocal inverse;
+    mutable std::vector<limb_t> quotient, product;
+};
+
+unsigned window_bits(size_t bits)
+{
+    static size_t const limits[] = {7, 36, 140, 450, 1303, 3529};
+    unsigned k = 1;
+    while (k < 7 && bits > limits[k - 1]) {
+        k++;
+    }
+    return k;
+}
+
+bool test_bit(limb_t const *e, size_t i)
+{
+    return (e[i / LIMB_BITS] >> (i % LIMB_BITS)) & 1;
+}
+
+// r = a^e for a non-zero e in the arithmetic of the context: runs of
+// up to k bits that start and end with a one are taken at once from the
+// table of odd powers a, a^3, ..., a^(2^k - 1), zeros in between cost a
+// squaring each
+template <typename Context>
+void power(limb_t *r, Context const &ctx, limb_t const *a, limb_t const *e, size_t en)
+{
+    size_t n = ctx.size();
+    size_t bits = en * LIMB_BITS;
+    while (!test_bit(e, bits - 1)) {
+        bits--;
+    }
+    unsigned k = window_bits(bits);
+    std::vector<limb_t> table(n << (k - 1)), a2(n);
+    std::copy(a, a + n, table.begin());
+    ctx.sqr(a2.data(), a);
+    for (size_t i = 1; i < (static_cast<size_t>(1) << (k - 1)); i++) {
+        ctx.mul(table.data() + i * n, table.data() + (i - 1) * n, a2.data());
+    }
+
+    bool first = true;
+    for (size_t i = bits; i != 0;) {
+        if (!test_bit(e, i - 1)) {
+            ctx.sqr(r, r);
+            i--;
+            continue;
+        }
+        size_t low = (i > k ? i - k : 0);
+        while (!test_bit(e, low)) {
+            low++;
+        }
+        size_t window = 0;
+        for (size_t j = i; j != low; j--) {
+            window = 2 * window + test_bit(e, j - 1);
+        }
+        if (first) {
+            std::copy(table.begin() + (window / 2) * n, table.begin() + (window / 2 + 1) * n, r);
+            first = false;
+        } else {
+            for (size_t j = low; j != i; j++) {
+                ctx.sqr(r, r);
+            }
+            ctx.mul(r, r, table.data() + (window / 2) * n);
+        }
+        i = low;
+    }
+}
+}
+
+montgomery::montgomery(limb_t const *m, size_t n)
+    : modulus(m, m + n), inverse(negated_inverse(m, n)), r2(n), product(2 * n), scratch(4 * n)
+{
+    // R^2 mod m out of B^2n
+    std::vector<limb_t> power(2 * n + 1), quotient(n + 2);
+    power[2 * n] = 1;
+    divrem(quotient.data(), r2.data(), power.data(), 2 * n + 1, m, n);
+}
+
+size_t montgomery::size() const
+{
+    return modulus.size();
+}
+
+// word by word, every step clears the lowest limb of t with a multiple
+// of m; above REDC_MUL_THRESHOLD the whole quotient q = t m' mod R is
+// taken from one product instead
+void montgomery::reduce(limb_t *r) const
+{
+    size_t n = size();
+    limb_t const *m = modulus.data();
+    limb_t *t = product.data();
+    limb_t top = 0;
+    if (n < REDC_MUL_THRESHOLD) {
+        for (size_t i = 0; i < n; i++) {
+            limb_t carry = addmul_1(t + i, m, n, t[i] * inverse[0]);
+            top += add_1(t + i + n, t + i + n, n - i, carry);
+        }
+    } else {
+        limb_t *q = scratch.data(), *qm = q + 2 * n;
+        ::mul(q, t, n, inverse.data(), n);
+        ::mul(qm, q, n, m, n);
+        top = add_n(t, t, qm, 2 * n);
+    }
+    if (top != 0 || compare_n(t + n, m, n) >= 0) {
+        sub_n(r, t + n, m, n);
+    } else {
+        std::copy(t + n, t + 2 * n, r);
+    }
+}
+
+void montgomery::to_montgomery(limb_t *r, limb_t const *a) const
+{
+    mul(r, a, r2.data());
+}
+
+void montgomery::from_montgomery(limb_t *r, limb_t const *a) const
+{
+    size_t n = size();
+    std::copy(a, a + n, product.begin());
+    std::fill(product.begin() + n, product.end(), 0);
+    reduce(r);
+}
+
+void montgomery::mul(limb_t *r, limb_t const *a, limb_t const *b) const
+{
+    ::mul(product.data(), a, size(), b, size());
+    reduce(r);
+}
+
+void montgomery::sqr(limb_t *r, limb_t const *a) const
+{
+    ::sqr(product.data(), a, size());
+    reduce(r);
+}
+
+void powmod(limb_t *r, limb_t const *a, size_t an, limb_t const *e, size_t en, limb_t const *m, size_t n)
+{
+    std::vector<limb_t> base(n);
+    if (an >= n) {
+        std::vector<limb_t> quotient(an - n + 1);
+        divrem(quotient.data(), base.data(), a, an, m, n);
+    } else {
+        std::copy(a, a + an, base.begin());
+    }
+    if (m[0] % 2 == 0) {
+        power(r, plain_context(m, n), base.data(), e, en);
+        return;
+    }
+    montgomery ctx(m, n);
+    ctx.to_montgomery(base.data(), base.data());
+    power(r, ctx, base.data(), e, en);
+    ctx.from_montgomery(r, r);
+}
@@ -0,0 +1,121 @@
+#include "limb_arithmetic.h"
+
+#if defined(__x86_64__)
+namespace {
+bool const HAS_ADX = __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("adx");
+
+// r[0, n) = a * b + c for n divisible by 4, returns the top limb; mulx
+// leaves the flags alone, so the low halves go through a single adcx chain
+limb_t mul_1_rows(limb_t *r, limb_t const *a, size_t n, limb_t b, limb_t c)
+{
+    limb_t lo, hi;
+    ptrdiff_t i = -static_cast<ptrdiff_t>(n);
+    __asm__("xor %k[lo], %k[lo]\n"
+            "1:\n\t"
+            "mulx (%[a],%[i],8), %[lo], %[hi]\n\t"
+            "adcx %[c], %[lo]\n\t"
+            "mov %[lo], (%[r],%[i],8)\n\t"
+            "mulx 8(%[a],%[i],8), %[lo], %[c]\n\t"
+            "adcx %[hi], %[lo]\n\t"
+            "mov %[lo], 8(%[r],%[i],8)\n\t"
+            "mulx 16(%[a],%[i],8), %[lo], %[hi]\n\t"
+            "adcx %[c], %[lo]\n\t"
+            "mov %[lo], 16(%[r],%[i],8)\n\t"
+            "mulx 24(%[a],%[i],8), %[lo], %[c]\n\t"
+            "adcx %[hi], %[lo]\n\t"
+            "mov %[lo], 24(%[r],%[i],8)\n\t"
+            "lea 4(%[i]), %[i]\n\t"
+            "jrcxz 2f\n\t"
+            "jmp 1b\n"
+            "2:\n\t"
+            "mov $0, %k[lo]\n\t"
+            "adcx %[lo], %[c]"
+            : [i] "+c"(i), [c] "+&r"(c), [lo] "=&r"(lo), [hi] "=&r"(hi)
+            : [r] "r"(r + n), [a] "r"(a + n), "d"(b)
+            : "cc", "memory");
+    return c;
+}
+
+// r[0, n) += a * b + c for n divisible by 4, returns the top limb; the
+// low halves are added along the CF chain (adcx) and the high halves of
+// the previous products along the OF chain (adox), so the two additions
+// of every limb do not wait for each other
+limb_t addmul_1_rows(limb_t *r, limb_t const *a, size_t n, limb_t b, limb_t c)
+{
+    limb_t lo, hi;
+    ptrdiff_t i = -static_cast<ptrdiff_t>(n);
+    __asm__("xor %k[lo], %k[lo]\n"
+            "1:\n\t"
+            "mulx (%[a],%[i],8), %[lo], %[hi]\n\t"
+            "adcx (%[r],%[i],8), %[lo]\n\t"
+            "adox %[c], %[lo]\n\t"
+            "mov %[lo], (%[r],%[i],8)\n\t"
+            "mulx 8(%[a],%[i],8), %[lo], %[c]\n\t"
+            "adcx 8(%[r],%[i],8), %[lo]\n\t"
+            "adox %[hi], %[lo]\n\t"
+            "mov %[lo], 8(%[r],%[i],8)\n\t"
+            "mulx 16(%[a],%[i],8), %[lo], %[hi]\n\t"
+            "adcx 16(%[r],%[i],8), %[lo]\n\t"
+            "adox %[c], %[lo]\n\t"
+            "mov %[lo], 16(%[r],%[i],8)\n\t"
+            "mulx 24(%[a],%[i],8), %[lo], %[c]\n\t"
+            "adcx 24(%[r],%[i],8), %[lo]\n\t"
+            "adox %[hi], %[lo]\n\t"
+            "mov %[lo], 24(%[r],%[i],8)\n\t"
+            "lea 4(%[i]), %[i]\n\t"
+            "jrcxz 2f\n\t"
+            "jmp 1b\n"
+            "2:\n\t"
+            "mov $0, %k[lo]\n\t"
+            "adcx %[lo], %[c]\n\t"
+            "adox %[lo], %[c]"
+            : [i] "+c"(i), [c] "+&r"(c), [lo] "=&r"(lo), [hi] "=&r"(hi)
+            : [r] "r"(r + n), [a] "r"(a + n), "d"(b)
+            : "cc", "memory");
+    return c;
+}
+
+// the low n % 4 limbs go through the generic kernels and hand their
+// carry to the unrolled loop
+limb_t mul_1_adx(limb_t *r, limb_t const *a, size_t n, limb_t b)
+{
+    size_t head = n % 4;
+    limb_t carry = mul_1(r, a, head, b);
+    return (head != n ? mul_1_rows(r + head, a + head, n - head, b, carry) : carry);
+}
+
+limb_t addmul_1_adx(limb_t *r, limb_t const *a, size_t n, limb_t b)
+{
+    size_t head = n % 4;
+    limb_t carry = addmul_1(r, a, head, b);
+    return (head != n ? addmul_1_rows(r + head, a + head, n - head, b, carry) : carry);
+}
+}
+
+bool cpu_has_adx()
+{
+    return HAS_ADX && !generic_kernels_forced();
+}
+
+void mul_basecase_adx(limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn)
+{
+    r[an] = mul_1_adx(r, a, an, b[0]);
+    for (size_t j = 1; j < bn; j++) {
+        r[an + j] = addmul_1_adx(r + j, a, an, b[j]);
+    }
+}
+
+void sqr_basecase_adx(limb_t *r, limb_t const *a, size_t n)
+{
+    r[0] = 0;
+    r[2 * n - 1] = 0;
+    if (n > 1) {
+        r[n] = mul_1_adx(r + 1, a + 1, n - 1, a[0]);
+        for (size_t i = 1; i + 1 < n; i++) {
+            r[n + i] = addmul_1_adx(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+        }
+        r[2 * n - 1] = lshift(r + 1, r + 1, 2 * n - 2, 1);
+    }
+    add_diagonal(r, a, n);
+}
+#endif
@@ -0,0 +1,83 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "big_integer.h"
+#include "limb_arithmetic.h"
+
+// Times the schoolbook product below KARATSUBA_THRESHOLD: the generic
+// rows, the mulx/adcx/adox rows and operator* of big_integer, which goes
+// through whichever rows were picked at startup.
+
+namespace {
+typedef void (*basecase_fn)(limb_t *, limb_t const *, size_t, limb_t const *, size_t);
+
+std::mt19937_64 rng(42);
+
+template <typename F>
+double nanoseconds_per_call(size_t iterations, F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        f();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+double time_basecase(basecase_fn fn, size_t n, size_t iterations)
+{
+    std::vector<limb_t> a(n), b(n), r(2 * n);
+    for (size_t i = 0; i < n; i++) {
+        a[i] = rng();
+        b[i] = rng();
+    }
+    return nanoseconds_per_call(iterations, [&]() {
+        fn(r.data(), a.data(), n, b.data(), n);
+        a[0] ^= r[n];
+    });
+}
+
+big_integer random_integer(size_t n)
+{
+    big_integer x;
+    for (size_t i = 0; i < 2 * n; i++) {
+        x <<= 32;
+        x += static_cast<uint32_t>(rng());
+    }
+    return x;
+}
+
+double time_operator(size_t n, size_t iterations)
+{
+    big_integer a = random_integer(n), b = random_integer(n), r;
+    return nanoseconds_per_call(iterations, [&]() {
+        r = a * b;
+    });
+}
+}
+
+int main()
+{
+#if defined(__x86_64__)
+    bool adx = cpu_has_adx();
+#else
+    bool adx = false;
+#endif
+    std::printf("%6s %12s %12s %12s %8s\n", "limbs", "generic ns", "adx ns", "operator* ns", "speedup");
+    for (size_t n = 4; n < KARATSUBA_THRESHOLD; n += 4) {
+        size_t iterations = 20000000 / (n * n);
+        double generic = time_basecase(mul_basecase_generic, n, iterations);
+        double op = time_operator(n, iterations);
+        if (adx) {
+#if defined(__x86_64__)
+            double fast = time_basecase(mul_basecase_adx, n, iterations);
+            std::printf("%6zu %12.1f %12.1f %12.1f %7.2fx\n", n, generic, fast, op, generic / fast);
+#endif
+        } else {
+            std::printf("%6zu %12.1f %12s %12.1f %8s\n", n, generic, "-", op, "-");
+        }
+    }
+    return 0;
+}
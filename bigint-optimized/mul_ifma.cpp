@@ -0,0 +1,103 @@
+#include "limb_arithmetic.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+bool const HAS_IFMA = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512ifma");
+
+constexpr unsigned DIGIT_BITS = 52;
+constexpr limb_t DIGIT_MASK = (static_cast<limb_t>(1) << DIGIT_BITS) - 1;
+constexpr size_t LANES = 8;
+
+size_t digit_count(size_t n)
+{
+    return (n * LIMB_BITS + DIGIT_BITS - 1) / DIGIT_BITS;
+}
+
+void to_digits(limb_t *d, limb_t const *a, size_t n)
+{
+    for (size_t i = 0, dn = digit_count(n); i < dn; i++) {
+        size_t bit = i * DIGIT_BITS, w = bit / LIMB_BITS;
+        unsigned offset = bit % LIMB_BITS;
+        limb_t v = a[w] >> offset;
+        if (offset + DIGIT_BITS > LIMB_BITS && w + 1 < n) {
+            v |= a[w + 1] << (LIMB_BITS - offset);
+        }
+        d[i] = v & DIGIT_MASK;
+    }
+}
+
+// column sums of the digit product, the low halves of the 52 x 52 bit
+// products of column k go to lo[k] and the high halves to hi[k]; the
+// output is scanned eight columns at a time with the digits of a read
+// from a window that slides against the broadcast digit of b, and even
+// and odd digits of b go to separate accumulators to keep two
+// independent chains per half
+__attribute__((target("avx512f,avx512ifma")))
+void mul_columns(limb_t *lo, limb_t *hi, limb_t const *a, size_t an, limb_t const *b, size_t bn)
+{
+    for (size_t k = 0; k < an + bn - 1; k += LANES) {
+        __m512i l0 = _mm512_setzero_si512(), h0 = l0, l1 = l0, h1 = l0;
+        size_t j = (k + 1 > an ? k + 1 - an : 0), last = std::min(bn, k + LANES);
+        for (; j + 1 < last; j += 2) {
+            __m512i x0 = _mm512_loadu_si512(a + k - j), y0 = _mm512_set1_epi64(static_cast<long long>(b[j]));
+            __m512i x1 = _mm512_loadu_si512(a + k - j - 1), y1 = _mm512_set1_epi64(static_cast<long long>(b[j + 1]));
+            l0 = _mm512_madd52lo_epu64(l0, x0, y0);
+            h0 = _mm512_madd52hi_epu64(h0, x0, y0);
+            l1 = _mm512_madd52lo_epu64(l1, x1, y1);
+            h1 = _mm512_madd52hi_epu64(h1, x1, y1);
+        }
+        if (j < last) {
+            __m512i x0 = _mm512_loadu_si512(a + k - j), y0 = _mm512_set1_epi64(static_cast<long long>(b[j]));
+            l0 = _mm512_madd52lo_epu64(l0, x0, y0);
+            h0 = _mm512_madd52hi_epu64(h0, x0, y0);
+        }
+        _mm512_storeu_si512(lo + k, _mm512_add_epi64(l0, l1));
+        _mm512_storeu_si512(hi + k, _mm512_add_epi64(h0, h1));
+    }
+}
+}
+
+bool cpu_has_ifma()
+{
+    return HAS_IFMA && !generic_kernels_forced();
+}
+
+void mul_ifma(limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn)
+{
+    size_t adn = digit_count(an), bdn = digit_count(bn), cn = adn + bdn - 1;
+    // the window over a may reach LANES - 1 digits past either end
+    std::vector<limb_t> ad(adn + 2 * LANES), bd(bdn);
+    std::vector<limb_t> lo(cn + LANES), hi(cn + LANES);
+    to_digits(ad.data() + LANES, a, an);
+    to_digits(bd.data(), b, bn);
+    mul_columns(lo.data(), hi.data(), ad.data() + LANES, adn, bd.data(), bdn);
+
+    // column k weighs lo[k] + hi[k - 1], the carries are propagated while
+    // the 52-bit digits are packed back into limbs
+    double_limb_t carry = 0, bits = 0;
+    unsigned filled = 0;
+    size_t rn = an + bn, out = 0;
+    for (size_t k = 0; out < rn; k++) {
+        double_limb_t column = carry;
+        if (k < cn) {
+            column += lo[k];
+        }
+        if (k != 0 && k - 1 < cn) {
+            column += hi[k - 1];
+        }
+        carry = column >> DIGIT_BITS;
+        bits |= static_cast<double_limb_t>(static_cast<limb_t>(column) & DIGIT_MASK) << filled;
+        filled += DIGIT_BITS;
+        if (filled >= LIMB_BITS) {
+            r[out++] = static_cast<limb_t>(bits);
+            bits >>= LIMB_BITS;
+            filled -= LIMB_BITS;
+        }
+    }
+}
+#endif
@@ -0,0 +1,239 @@
+#include "limb_arithmetic.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Three-prime number-theoretic transform over 32-bit pieces of the limbs.
+// Every prime is below 2^32 and supports transforms of length 2^27, the
+// product of the primes exceeds 2^94 > 2^27 * 2^64, so each convolution
+// coefficient is recovered exactly by CRT.
+
+namespace {
+constexpr size_t PIECES = LIMB_BITS / 32;
+constexpr size_t NTT_MAX_LENGTH = static_cast<size_t>(1) << 27;
+
+uint32_t pow_mod(uint64_t a, uint64_t e, uint64_t p)
+{
+    uint64_t result = 1;
+    a %= p;
+    for (; e != 0; e >>= 1) {
+        if (e & 1) {
+            result = result * a % p;
+        }
+        a = a * a % p;
+    }
+    return static_cast<uint32_t>(result);
+}
+
+class ntt_field
+{
+public:
+    ntt_field(uint32_t p, uint32_t g) : p(p), g(g), inv(p)
+    {
+        for (int i = 0; i < 4; i++) {
+            inv *= 2 - p * inv;
+        }
+        r2 = static_cast<uint32_t>((static_cast<uint64_t>(1) << 63) % p * 2 % p);
+        table = std::make_shared<std::vector<uint32_t> const>(2, to_montgomery(1));
+    }
+
+    uint32_t modulus() const
+    {
+        return p;
+    }
+
+    // t * 2^-32 mod p for t < p * 2^32
+    uint32_t reduce(uint64_t t) const
+    {
+        uint32_t m = static_cast<uint32_t>(t) * inv;
+        uint32_t th = static_cast<uint32_t>(t >> 32);
+        uint32_t mh = static_cast<uint32_t>((static_cast<uint64_t>(m) * p) >> 32);
+        return th < mh ? th - mh + p : th - mh;
+    }
+
+    // a * b mod p when b is in Montgomery form
+    uint32_t mul(uint32_t a, uint32_t b) const
+    {
+        return reduce(static_cast<uint64_t>(a) * b);
+    }
+
+    uint32_t to_montgomery(uint32_t a) const
+    {
+        return mul(a, r2);
+    }
+
+    uint32_t add(uint32_t a, uint32_t b) const
+    {
+        return a >= p - b ? a - (p - b) : a + b;
+    }
+
+    uint32_t sub(uint32_t a, uint32_t b) const
+    {
+        return a >= b ? a - b : a + (p - b);
+    }
+
+    // roots[len + i] = w_{2 len}^i in Montgomery form for len < n. The
+    // levels of a longer table include those of every shorter one, so a
+    // single table per prime grows to the longest transform so far; the
+    // tables it replaces stay alive while a transform still reads them.
+    std::shared_ptr<std::vector<uint32_t> const> roots(size_t n) const
+    {
+        std::lock_guard<std::mutex> guard(table_lock);
+        if (table->size() < n) {
+            std::vector<uint32_t> grown(*table);
+            grown.resize(n);
+            for (size_t len = table->size(); len < n; len *= 2) {
+                uint32_t w = to_montgomery(pow_mod(g, (p - 1) / (2 * len), p));
+                // w_{2 len}^2i = w_len^i, so the even powers are already there
+                for (size_t i = 0; i < len; i += 2) {
+                    grown[len + i] = grown[len / 2 + i / 2];
+                    grown[len + i + 1] = reduce(static_cast<uint64_t>(grown[len + i]) * w);
+                }
+            }
+            table = std::make_shared<std::vector<uint32_t> const>(std::move(grown));
+        }
+        return table;
+    }
+
+    // decimation in frequency, the output is left in bit-reversed order
+    void forward(uint32_t *a, size_t n, uint32_t const *w) const
+    {
+        for (size_t len = n / 2; len != 0; len /= 2) {
+            for (size_t j = 0; j < n; j += 2 * len) {
+                for (size_t i = 0; i < len; i++) {
+                    uint32_t u = a[j + i], v = a[j + i + len];
+                    a[j + i] = add(u, v);
+                    a[j + i + len] = mul(sub(u, v), w[len + i]);
+                }
+            }
+        }
+    }
+
+    // decimation in time from bit-reversed order, without the 1/n factor;
+    // w_{2 len}^-i = -w_{2 len}^(len - i) comes from the forward roots
+    void inverse(uint32_t *a, size_t n, uint32_t const *w) const
+    {
+        for (size_t len = 1; len < n; len *= 2) {
+            for (size_t j = 0; j < n; j += 2 * len) {
+                uint32_t u = a[j], v = a[j + len];
+                a[j] = add(u, v);
+                a[j + len] = sub(u, v);
+                for (size_t i = 1; i < len; i++) {
+                    u = a[j + i];
+                    v = mul(a[j + i + len], w[2 * len - i]);
+                    a[j + i] = sub(u, v);
+                    a[j + i + len] = add(u, v);
+                }
+            }
+        }
+    }
+
+private:
+    uint32_t p, g, inv, r2;
+    mutable std::mutex table_lock;
+    mutable std::shared_ptr<std::vector<uint32_t> const> table;
+};
+
+ntt_field const FIELDS[] = {
+    {3221225473u, 5}, // 3 * 2^30 + 1
+    {3489660929u, 3}, // 13 * 2^28 + 1
+    {2281701377u, 3}, // 17 * 2^27 + 1
+};
+
+uint32_t piece(limb_t const *a, size_t i)
+{
+    return static_cast<uint32_t>(a[i / PIECES] >> (32 * (i % PIECES)));
+}
+
+void load(uint32_t *out, limb_t const *a, size_t an, size_t n, uint32_t p)
+{
+    size_t count = an * PIECES;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t x = piece(a, i);
+        out[i] = (x >= p ? x - p : x);
+    }
+    std::fill(out + count, out + n, 0);
+}
+
+// residues of a * b modulo one prime, in natural order; a square needs
+// a single forward transform
+std::vector<uint32_t> convolution(ntt_field const &field, limb_t const *a, size_t an,
+                                  limb_t const *b, size_t bn, size_t n)
+{
+    uint32_t p = field.modulus();
+    bool square = (a == b && an == bn);
+    std::vector<uint32_t> fa(n), fb(square ? 0 : n);
+    std::shared_ptr<std::vector<uint32_t> const> w = field.roots(n);
+    load(fa.data(), a, an, n, p);
+    field.forward(fa.data(), n, w->data());
+    if (!square) {
+        load(fb.data(), b, bn, n, p);
+        field.forward(fb.data(), n, w->data());
+    }
+    uint32_t const *other = (square ? fa.data() : fb.data());
+    for (size_t i = 0; i < n; i++) {
+        fa[i] = field.reduce(static_cast<uint64_t>(fa[i]) * other[i]);
+    }
+    fb = std::vector<uint32_t>();
+    field.inverse(fa.data(), n, w->data());
+
+    // undo both the 1/n and the 2^-32 of the pointwise product
+    uint64_t scale = pow_mod(n, p - 2, p);
+    scale = scale * field.to_montgomery(1) % p;
+    scale = scale * field.to_montgomery(1) % p;
+    for (size_t i = 0; i < n; i++) {
+        fa[i] = field.mul(fa[i], static_cast<uint32_t>(scale));
+    }
+    return fa;
+}
+}
+
+bool ntt_fits(size_t an, size_t bn)
+{
+    return (an + bn) * PIECES <= NTT_MAX_LENGTH;
+}
+
+void ntt_mul(limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn)
+{
+    size_t total = (an + bn) * PIECES;
+    size_t n = 1;
+    while (n < total - 1) {
+        n *= 2;
+    }
+    std::vector<uint32_t> r1 = convolution(FIELDS[0], a, an, b, bn, n);
+    std::vector<uint32_t> r2 = convolution(FIELDS[1], a, an, b, bn, n);
+    std::vector<uint32_t> r3 = convolution(FIELDS[2], a, an, b, bn, n);
+
+    // Garner: x = x1 + x2 p1 + x3 p1 p2
+    ntt_field const &f2 = FIELDS[1], &f3 = FIELDS[2];
+    uint64_t p1 = FIELDS[0].modulus(), p2 = f2.modulus(), p3 = f3.modulus();
+    uint32_t c2 = f2.to_montgomery(pow_mod(p1, p2 - 2, p2));
+    uint32_t c3 = f3.to_montgomery(pow_mod(p1 * p2 % p3, p3 - 2, p3));
+    uint32_t p1_mod3 = f3.to_montgomery(static_cast<uint32_t>(p1 % p3));
+    uint64_t p12 = p1 * p2;
+    uint64_t p12_low = p12 & UINT32_MAX, p12_high = p12 >> 32;
+
+    std::fill(r, r + an + bn, 0);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < total; i++) {
+        uint64_t low = 0, high = 0;
+        if (i < n) {
+            uint32_t x1 = r1[i];
+            uint32_t x2 = f2.mul(f2.sub(r2[i], x1), c2);
+            uint32_t x1_mod3 = (x1 >= p3 ? x1 - static_cast<uint32_t>(p3) : x1);
+            uint32_t t = f3.add(x1_mod3, f3.mul(x2, p1_mod3));
+            uint64_t x3 = f3.mul(f3.sub(r3[i], t), c3);
+
+            uint64_t s = x1 + x2 * p1;
+            uint64_t w0 = (s & UINT32_MAX) + x3 * p12_low;
+            uint64_t w1 = (s >> 32) + x3 * p12_high + (w0 >> 32);
+            low = w0 & UINT32_MAX;
+            high = w1;
+        }
+        uint64_t sum = low + (carry & UINT32_MAX);
+        carry = high + (carry >> 32) + (sum >> 32);
+        r[i / PIECES] |= static_cast<limb_t>(sum & UINT32_MAX) << (32 * (i % PIECES));
+    }
+}
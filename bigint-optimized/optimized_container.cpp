@@ -2,7 +2,7 @@
 
 optimized_container::optimized_container() : size_(0), is_small(true) {}
 
-optimized_container::optimized_container(uint32_t x) : size_(1), is_small(true)
+optimized_container::optimized_container(limb_t x) : size_(1), is_small(true)
 {
     num.value[0] = x;
 }
@@ -17,6 +17,14 @@ optimized_container::optimized_container(optimized_container const &other) : siz
     }
 }
 
+// leaves other empty and small, the heap block changes hands as is
+optimized_container::optimized_container(optimized_container &&other) noexcept
+    : size_(other.size_), is_small(other.is_small), num(other.num)
+{
+    other.size_ = 0;
+    other.is_small = true;
+}
+
 optimized_container::~optimized_container()
 {
     if (!is_small) {
@@ -24,7 +32,7 @@ optimized_container::~optimized_container()
     }
 }
 
-void optimized_container::push_back(uint32_t x)
+void optimized_container::push_back(limb_t x)
 {
     if (!is_small) {
         unshare();
@@ -32,9 +40,9 @@ void optimized_container::push_back(uint32_t x)
     } else {
         if (size_ == MAX_SZ) {
             is_small = false;
-            std::vector<uint32_t> tmp(num.value, num.value + size_);
+            std::vector<limb_t> tmp(num.value, num.value + size_);
             tmp.push_back(x);
-            num.data = new shared_pointer(tmp);
+            num.data = new shared_pointer(std::move(tmp));
         } else {
             num.value[size_] = x;
         }
@@ -61,17 +69,52 @@ void optimized_container::reverse()
     }
 }
 
+void optimized_container::resize(size_t sz)
+{
+    if (!is_small) {
+        unshare();
+        num.data->resize(sz);
+    } else if (sz > MAX_SZ) {
+        is_small = false;
+        std::vector<limb_t> tmp(num.value, num.value + size_);
+        tmp.resize(sz);
+        num.data = new shared_pointer(std::move(tmp));
+    } else if (sz > size_) {
+        std::fill(num.value + size_, num.value + sz, 0);
+    }
+    size_ = sz;
+}
+
+limb_t const* optimized_container::data() const
+{
+    return is_small ? num.value : num.data->data();
+}
+
+limb_t* optimized_container::data()
+{
+    if (is_small) {
+        return num.value;
+    }
+    unshare();
+    return num.data->data();
+}
+
 size_t optimized_container::size() const
 {
     return size_;
 }
 
-uint32_t const& optimized_container::operator[](size_t ind) const
+bool optimized_container::shares_buffer(optimized_container const &other) const
+{
+    return !is_small && !other.is_small && num.data == other.num.data;
+}
+
+limb_t const& optimized_container::operator[](size_t ind) const
 {
     return (!is_small ? (*num.data)[ind] : num.value[ind]);
 }
 
-uint32_t& optimized_container::operator[](size_t ind)
+limb_t& optimized_container::operator[](size_t ind)
 {
     if (is_small) {
         return num.value[ind];
@@ -81,7 +124,7 @@ uint32_t& optimized_container::operator[](size_t ind)
     }
 }
 
-uint32_t optimized_container::back() const
+limb_t optimized_container::back() const
 {
     return is_small ? num.value[size_ - 1] : num.data->back();
 }
@@ -103,6 +146,19 @@ optimized_container &optimized_container::operator=(optimized_container const& o
     return *this;
 }
 
+optimized_container &optimized_container::operator=(optimized_container &&other) noexcept
+{
+    swap(other);
+    return *this;
+}
+
+void optimized_container::swap(optimized_container &other) noexcept
+{
+    std::swap(size_, other.size_);
+    std::swap(is_small, other.is_small);
+    std::swap(num, other.num);
+}
+
 bool operator==(const optimized_container &first, const optimized_container &second)
 {
     if (first.size() != second.size()) {
@@ -1,7 +1,6 @@
 #ifndef OPTIMIZED_CONTAINER_H
 #define OPTIMIZED_CONTAINER_H
 
-#include <cstdint>
 #include <algorithm>
 #include "shared_pointer.h"
 
@@ -9,17 +8,24 @@ struct optimized_container {
 public:
     static constexpr size_t MAX_SZ = 5;
     optimized_container();
-    optimized_container(uint32_t);
+    optimized_container(limb_t);
     optimized_container(optimized_container const &);
+    optimized_container(optimized_container &&) noexcept;
     ~optimized_container();
-    void push_back(uint32_t);
+    void push_back(limb_t);
     void pop_back();
     void reverse();
+    void resize(size_t);
+    limb_t const* data() const;
+    limb_t* data();
     size_t size() const;
-    uint32_t const& operator[](size_t) const;
-    uint32_t& operator[](size_t);
-    uint32_t back() const;
+    bool shares_buffer(optimized_container const&) const;
+    limb_t const& operator[](size_t) const;
+    limb_t& operator[](size_t);
+    limb_t back() const;
     optimized_container& operator=(optimized_container const&);
+    optimized_container& operator=(optimized_container &&) noexcept;
+    void swap(optimized_container &) noexcept;
     friend bool operator==(optimized_container const&, optimized_container const&);
 
 private:
@@ -28,7 +34,7 @@ private:
     size_t size_;
     bool is_small;
     union {
-        uint32_t value[MAX_SZ];
+        limb_t value[MAX_SZ];
         shared_pointer *data;
     } num;
 };
@@ -2,7 +2,9 @@
 
 shared_pointer::shared_pointer() : digits(), ref_cnt(1) {}
 
-shared_pointer::shared_pointer(const std::vector<uint32_t> &other) : digits(other), ref_cnt(1) {}
+shared_pointer::shared_pointer(const std::vector<limb_t> &other) : digits(other), ref_cnt(1) {}
+
+shared_pointer::shared_pointer(std::vector<limb_t> &&other) noexcept : digits(std::move(other)), ref_cnt(1) {}
 
 shared_pointer::shared_pointer(const shared_pointer &other) : digits(other.digits), ref_cnt(1) {}
 
@@ -40,7 +42,7 @@ void shared_pointer::reverse()
     std::reverse(digits.begin(), digits.end());
 }
 
-void shared_pointer::push_back(uint32_t val)
+void shared_pointer::push_back(limb_t val)
 {
     digits.push_back(val);
 }
@@ -50,17 +52,32 @@ void shared_pointer::pop_back()
     digits.pop_back();
 }
 
-const uint32_t &shared_pointer::operator[](size_t ind) const
+void shared_pointer::resize(size_t sz)
+{
+    digits.resize(sz);
+}
+
+const limb_t *shared_pointer::data() const
+{
+    return digits.data();
+}
+
+limb_t *shared_pointer::data()
+{
+    return digits.data();
+}
+
+const limb_t &shared_pointer::operator[](size_t ind) const
 {
     return digits[ind];
 }
 
-uint32_t &shared_pointer::operator[](size_t ind)
+limb_t &shared_pointer::operator[](size_t ind)
 {
     return digits[ind];
 }
 
-uint32_t shared_pointer::back() const
+limb_t shared_pointer::back() const
 {
     return digits.back();
 }